@@ -2,6 +2,8 @@
 
 ACorridorBase::ACorridorBase()
 {
+	InstancedMesh = nullptr;
+	bHasGameplayState = false;
 }
 
 void ACorridorBase::BeginPlay()
@@ -11,3 +13,11 @@ void ACorridorBase::BeginPlay()
 void ACorridorBase::Tick(float DeltaTime)
 {
 }
+
+void ACorridorBase::OnReleasedToPool_Implementation()
+{
+}
+
+void ACorridorBase::OnAcquiredFromPool_Implementation()
+{
+}
@@ -2,10 +2,13 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "DungeonActorPool.h"
 #include "CorridorBase.generated.h"
 
+class UStaticMesh;
+
 UCLASS()
-class TP4_API ACorridorBase : public AActor
+class TP4_API ACorridorBase : public AActor, public IDungeonPooledActor
 {
 	GENERATED_BODY()
 	
@@ -16,4 +19,21 @@ public:
 
 	virtual void Tick(float DeltaTime) override;
 
+	// Nothing to reset in the base corridor, subclasses with gameplay state clear it here
+	virtual void OnReleasedToPool_Implementation() override;
+
+	virtual void OnAcquiredFromPool_Implementation() override;
+
+	// Mesh used for this corridor class when corridors are instanced, classes without one are always spawned as actors
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Dungeon Generation")
+	UStaticMesh* InstancedMesh;
+
+	// Transform of the instanced mesh relative to the corridor, the corridor being scaled like the spawned actors
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Dungeon Generation")
+	FTransform InstancedMeshTransform;
+
+	// Corridors with gameplay state stay replicated actors when the layout is replicated, clients never spawn them locally
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Dungeon Generation")
+	bool bHasGameplayState;
+
 };
@@ -0,0 +1,222 @@
+#include "CorridorMerging.h"
+#include "RoomGeometry.h"
+#include "DungeonScratch.h"
+#include "DungeonStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Corridor Merging"), STAT_DungeonCorridorMerging, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Corridor Junctions"), STAT_DungeonCorridorJunctions, STATGROUP_Dungeon);
+
+namespace
+{
+    /**
+     * Corridor segment lying on a row or a column, Line being the Y of a row or the X of a column
+     */
+    struct SAxisSegment
+    {
+    public:
+        double Line = 0.0;
+        double Min = 0.0;
+        double Max = 0.0;
+
+        // Lowest corridor index merged into the segment and its class
+        int32 Index = 0;
+        int32 ClassIndex = 0;
+    };
+
+    // Sorts the segments along their line and merges the overlapping or touching ones in place
+    void MergeAxisSegments(TDungeonScratchArray<SAxisSegment>& Segments)
+    {
+        Segments.Sort([](const SAxisSegment& A, const SAxisSegment& B)
+        {
+            if (A.Line != B.Line)
+            {
+                return A.Line < B.Line;
+            }
+            if (A.Min != B.Min)
+            {
+                return A.Min < B.Min;
+            }
+            return A.Index < B.Index;
+        });
+
+        int32 NumMerged = 0;
+        for (int32 i = 0; i < Segments.Num(); i++)
+        {
+            const SAxisSegment Segment = Segments[i];
+            if (NumMerged > 0)
+            {
+                SAxisSegment& Last = Segments[NumMerged - 1];
+                if (Last.Line == Segment.Line && Segment.Min <= Last.Max)
+                {
+                    Last.Max = FMath::Max(Last.Max, Segment.Max);
+                    if (Segment.Index < Last.Index)
+                    {
+                        Last.Index = Segment.Index;
+                        Last.ClassIndex = Segment.ClassIndex;
+                    }
+                    continue;
+                }
+            }
+            Segments[NumMerged++] = Segment;
+        }
+
+        Segments.SetNum(NumMerged, EAllowShrinking::No);
+    }
+}
+
+/**
+ * Replaces the corridor segments by the fewest segments covering the same rows and columns
+ * Segments are sorted per row and column and swept once, a merged segment takes the class of its first corridor
+ * Coordinates are compared exactly, segments of one path or of paths leaving the same room share them exactly
+ * Segments neither horizontal nor vertical are kept as they are
+ * @param Corridors - Corridor segments, merged in place
+ */
+void UCorridorMerging::MergeCorridors(TArray<FDungeonCorridorSegment>& Corridors)
+{
+    DUNGEON_SCOPE(STAT_DungeonCorridorMerging);
+
+    FMemMark Mark(FMemStack::Get());
+
+    TDungeonScratchArray<SAxisSegment> Rows;
+    TDungeonScratchArray<SAxisSegment> Columns;
+    TDungeonScratchArray<FDungeonCorridorSegment> Others;
+    Rows.Reserve(Corridors.Num());
+    Columns.Reserve(Corridors.Num());
+
+    for (int32 i = 0; i < Corridors.Num(); i++)
+    {
+        const FDungeonCorridorSegment& Corridor = Corridors[i];
+        if (Corridor.Start == Corridor.End)
+        {
+            continue;
+        }
+
+        if (Corridor.Start.Y == Corridor.End.Y)
+        {
+            Rows.Add({ Corridor.Start.Y, FMath::Min(Corridor.Start.X, Corridor.End.X), FMath::Max(Corridor.Start.X, Corridor.End.X), i, Corridor.ClassIndex });
+        }
+        else if (Corridor.Start.X == Corridor.End.X)
+        {
+            Columns.Add({ Corridor.Start.X, FMath::Min(Corridor.Start.Y, Corridor.End.Y), FMath::Max(Corridor.Start.Y, Corridor.End.Y), i, Corridor.ClassIndex });
+        }
+        else
+        {
+            Others.Add(Corridor);
+        }
+    }
+
+    MergeAxisSegments(Rows);
+    MergeAxisSegments(Columns);
+
+    Corridors.Reset(Rows.Num() + Columns.Num() + Others.Num());
+
+    for (const SAxisSegment& Row : Rows)
+    {
+        FDungeonCorridorSegment& Segment = Corridors.AddDefaulted_GetRef();
+        Segment.Start = FVector2D(Row.Min, Row.Line);
+        Segment.End = FVector2D(Row.Max, Row.Line);
+        Segment.ClassIndex = Row.ClassIndex;
+    }
+
+    for (const SAxisSegment& Column : Columns)
+    {
+        FDungeonCorridorSegment& Segment = Corridors.AddDefaulted_GetRef();
+        Segment.Start = FVector2D(Column.Line, Column.Min);
+        Segment.End = FVector2D(Column.Line, Column.Max);
+        Segment.ClassIndex = Column.ClassIndex;
+    }
+
+    Corridors.Append(Others);
+}
+
+/**
+ * Finds the T-junctions and crossings of merged corridors
+ * Columns are indexed in a uniform grid and each row is tested against the columns of the cells it touches
+ * Merged segments of one line never touch, so a point is on at most one row and one column: a segment gives
+ * two arms when the point is inside it and one at its ends, corners of a path only having two arms in total
+ * @param Corridors - Merged corridor segments
+ * @param OutJunctions - Receives the junctions, in row order
+ */
+void UCorridorMerging::FindJunctions(TConstArrayView<FDungeonCorridorSegment> Corridors, TArray<FDungeonCorridorJunction>& OutJunctions)
+{
+    DUNGEON_SCOPE(STAT_DungeonCorridorJunctions);
+
+    OutJunctions.Reset();
+
+    FMemMark Mark(FMemStack::Get());
+
+    // Reserved up front, growing a stack allocation leaves the old block behind until the mark is popped
+    TDungeonScratchArray<int32> Rows;
+    TDungeonScratchArray<int32> Columns;
+    TDungeonScratchArray<FBox2D> ColumnBounds;
+    Rows.Reserve(Corridors.Num());
+    Columns.Reserve(Corridors.Num());
+    ColumnBounds.Reserve(Corridors.Num());
+    double ColumnLength = 0.0;
+
+    for (int32 i = 0; i < Corridors.Num(); i++)
+    {
+        const FDungeonCorridorSegment& Corridor = Corridors[i];
+        if (Corridor.Start == Corridor.End)
+        {
+            continue;
+        }
+
+        if (Corridor.Start.Y == Corridor.End.Y)
+        {
+            Rows.Add(i);
+        }
+        else if (Corridor.Start.X == Corridor.End.X)
+        {
+            Columns.Add(i);
+            ColumnBounds.Add(FBox2D(FVector2D::Min(Corridor.Start, Corridor.End), FVector2D::Max(Corridor.Start, Corridor.End)));
+            ColumnLength += ColumnBounds.Last().GetSize().Y;
+        }
+    }
+
+    if (Rows.IsEmpty() || Columns.IsEmpty())
+    {
+        return;
+    }
+
+    // Cells about as large as an average column keep the number of cells each column is registered in low
+    SScratchRoomGrid Grid;
+    Grid.Build(ColumnBounds, ColumnLength / Columns.Num());
+
+    // A column may be registered in several cells a row touches, the row it was last tested with skips it
+    TDungeonScratchArray<int32> TestedRows;
+    TestedRows.Init(INDEX_NONE, Columns.Num());
+
+    for (int32 RowIndex = 0; RowIndex < Rows.Num(); RowIndex++)
+    {
+        const FDungeonCorridorSegment& Row = Corridors[Rows[RowIndex]];
+        const double Y = Row.Start.Y;
+        const double MinX = FMath::Min(Row.Start.X, Row.End.X);
+        const double MaxX = FMath::Max(Row.Start.X, Row.End.X);
+
+        Grid.ForEachInBox(FBox2D(FVector2D(MinX, Y), FVector2D(MaxX, Y)), [&](int32 ColumnIndex)
+        {
+            if (TestedRows[ColumnIndex] == RowIndex)
+            {
+                return;
+            }
+            TestedRows[ColumnIndex] = RowIndex;
+
+            const FBox2D& Column = ColumnBounds[ColumnIndex];
+            const double X = Column.Min.X;
+            if (X < MinX || X > MaxX || Y < Column.Min.Y || Y > Column.Max.Y)
+            {
+                return;
+            }
+
+            const int32 RowArms = (X > MinX && X < MaxX) ? 2 : 1;
+            const int32 ColumnArms = (Y > Column.Min.Y && Y < Column.Max.Y) ? 2 : 1;
+            if (RowArms + ColumnArms >= 3)
+            {
+                FDungeonCorridorJunction& Junction = OutJunctions.AddDefaulted_GetRef();
+                Junction.Location = FVector2D(X, Y);
+                Junction.NumArms = RowArms + ColumnArms;
+            }
+        });
+    }
+}
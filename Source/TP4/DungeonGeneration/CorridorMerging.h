@@ -0,0 +1,20 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "DungeonLayout.h"
+#include "CorridorMerging.generated.h"
+
+UCLASS()
+class TP4_API UCorridorMerging : public UObject
+{
+    GENERATED_BODY()
+
+public:
+
+    // Merges the overlapping or touching segments of each row and column, zero length segments are removed
+    static void MergeCorridors(TArray<FDungeonCorridorSegment>& Corridors);
+
+    // Finds where a row meets a column with at least three arms, expects merged corridors
+    static void FindJunctions(TConstArrayView<FDungeonCorridorSegment> Corridors, TArray<FDungeonCorridorJunction>& OutJunctions);
+};
@@ -0,0 +1,339 @@
+#include "CorridorRouter.h"
+#include "Algo/Reverse.h"
+
+namespace
+{
+    // Directions of the moves, the opposite of direction D being (D + 2) & 3
+    const FIntPoint DirectionOffsets[4] = { FIntPoint(1, 0), FIntPoint(0, 1), FIntPoint(-1, 0), FIntPoint(0, -1) };
+}
+
+/**
+ * Rasterizes the rooms into the occupancy grid and forgets the carved corridors
+ * A cell is occupied as soon as it touches a room, so corridors following cell centers keep half a cell away from rooms
+ * No mark is taken here, the grid is allocated on the stack of the caller after the room bounds
+ * @param Rooms - Footprints of all rooms
+ * @param RoomIndices - Rooms to avoid
+ * @param InCellSize - Size of a cell, roughly the width of a corridor
+ */
+void SCorridorRouter::Build(TConstArrayView<SRoomFootprint> Rooms, TConstArrayView<int32> RoomIndices, double InCellSize)
+{
+    NumCellsX = 0;
+    NumCellsY = 0;
+    RoomBits.Reset();
+    CarvedBits.Reset();
+
+    TDungeonScratchArray<FBox2D> Bounds;
+    Bounds.Reserve(RoomIndices.Num());
+    FBox2D GridBounds(ForceInit);
+    for (int32 RoomIndex : RoomIndices)
+    {
+        Bounds.Add(Rooms[RoomIndex].GetBounds());
+        GridBounds += Bounds.Last();
+    }
+
+    if (Bounds.Num() == 0)
+    {
+        return;
+    }
+
+    CellSize = FMath::Max(InCellSize, 1.0);
+    GridBounds = GridBounds.ExpandBy(CellSize * BorderCells);
+
+    // Coarsen very large dungeons rather than allocating huge grids
+    const FVector2D Size = GridBounds.GetSize();
+    if ((Size.X / CellSize + 1.0) * (Size.Y / CellSize + 1.0) > MaxCells)
+    {
+        CellSize = FMath::Max(CellSize, FMath::Sqrt(Size.X * Size.Y / MaxCells) + 1.0);
+        CellSize = FMath::Max(CellSize, FMath::Max(Size.X, Size.Y) / MaxCells + 1.0);
+    }
+
+    Origin = GridBounds.Min;
+    NumCellsX = FMath::FloorToInt32(Size.X / CellSize) + 1;
+    NumCellsY = FMath::FloorToInt32(Size.Y / CellSize) + 1;
+
+    const int32 NumWords = (NumCellsX * NumCellsY + 31) / 32;
+    RoomBits.SetNumZeroed(NumWords);
+    CarvedBits.SetNumZeroed(NumWords);
+
+    for (const FBox2D& Box : Bounds)
+    {
+        const FIntPoint MinCell = GetCell(Box.Min);
+        const FIntPoint MaxCell = GetCell(Box.Max);
+        for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+        {
+            for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+            {
+                SetBit(RoomBits, Y * NumCellsX + X);
+            }
+        }
+    }
+}
+
+/**
+ * Finds the cheapest path between two rooms with A*
+ * States are a cell and the direction it was entered from, so bends can be penalized
+ * Cells of other rooms are expensive and cells of corridors routed before are cheaper, so corridors merge where they can
+ * The search is limited to a window around both rooms, which keeps each route proportional to its length
+ * Edges whose window would exceed MaxSearchStates get an L-shaped path instead
+ * The cells of the path are carved afterwards
+ * @param Start - Start point, inside StartRoom
+ * @param StartRoom - Bounds of the room the path starts from, crossed at the regular cost
+ * @param End - End point, inside EndRoom
+ * @param EndRoom - Bounds of the room the path ends in, crossed at the regular cost
+ * @param OutLines - Receives the segments of the path, from Start to End
+ * @return Number of segments added
+ */
+int32 SCorridorRouter::Route(const FVector2D& Start, const FBox2D& StartRoom, const FVector2D& End, const FBox2D& EndRoom, TDungeonScratchArray<TPair<FVector2D, FVector2D>>& OutLines)
+{
+    const FIntPoint StartCell = NumCellsX > 0 ? GetCell(Start) : FIntPoint::ZeroValue;
+    const FIntPoint EndCell = NumCellsX > 0 ? GetCell(End) : FIntPoint::ZeroValue;
+
+    // Nothing to route between points of the same cell
+    if (StartCell == EndCell)
+    {
+        return AddLShapedLines(Start, End, OutLines);
+    }
+
+    const int32 Margin = FMath::Max(MinWindowMargin, FMath::Max(FMath::Abs(EndCell.X - StartCell.X), FMath::Abs(EndCell.Y - StartCell.Y)) / 2);
+    const FIntPoint WindowMin(FMath::Max(FMath::Min(StartCell.X, EndCell.X) - Margin, 0), FMath::Max(FMath::Min(StartCell.Y, EndCell.Y) - Margin, 0));
+    const FIntPoint WindowMax(FMath::Min(FMath::Max(StartCell.X, EndCell.X) + Margin, NumCellsX - 1), FMath::Min(FMath::Max(StartCell.Y, EndCell.Y) + Margin, NumCellsY - 1));
+    const int32 WindowSizeX = WindowMax.X - WindowMin.X + 1;
+    const int64 NumWindowStates = int64(WindowSizeX) * (WindowMax.Y - WindowMin.Y + 1) * 4;
+
+    // The window grows with the square of the edge length, very long edges are not worth their search state
+    if (NumWindowStates > MaxSearchStates)
+    {
+        return AddLShapedLines(Start, End, OutLines);
+    }
+
+    const int32 NumStates = int32(NumWindowStates);
+
+    if (States.Num() < NumStates)
+    {
+        States.SetNum(NumStates);
+    }
+
+    if (++SearchStamp == 0)
+    {
+        for (SSearchState& State : States)
+        {
+            State.Stamp = 0;
+        }
+        SearchStamp = 1;
+    }
+
+    const FIntPoint StartRoomMin = GetCell(StartRoom.Min);
+    const FIntPoint StartRoomMax = GetCell(StartRoom.Max);
+    const FIntPoint EndRoomMin = GetCell(EndRoom.Min);
+    const FIntPoint EndRoomMax = GetCell(EndRoom.Max);
+
+    auto GetStepCost = [&](const FIntPoint& Cell)
+    {
+        const int32 CellIndex = Cell.Y * NumCellsX + Cell.X;
+        if (GetBit(RoomBits, CellIndex)
+            && (Cell.X < StartRoomMin.X || Cell.Y < StartRoomMin.Y || Cell.X > StartRoomMax.X || Cell.Y > StartRoomMax.Y)
+            && (Cell.X < EndRoomMin.X || Cell.Y < EndRoomMin.Y || Cell.X > EndRoomMax.X || Cell.Y > EndRoomMax.Y))
+        {
+            return RoomStepCost;
+        }
+        return GetBit(CarvedBits, CellIndex) ? CarvedStepCost : StepCost;
+    };
+
+    auto GetState = [&](const FIntPoint& Cell, int32 Direction)
+    {
+        return ((Cell.Y - WindowMin.Y) * WindowSizeX + Cell.X - WindowMin.X) * 4 + Direction;
+    };
+
+    auto GetStateCell = [&](int32 State)
+    {
+        const int32 LocalCell = State / 4;
+        return FIntPoint(WindowMin.X + LocalCell % WindowSizeX, WindowMin.Y + LocalCell / WindowSizeX);
+    };
+
+    // Manhattan distance plus the bends still needed to reach the end cell from the current direction,
+    // so the many paths of equal length are not all explored
+    // Distances are counted at the regular step cost, carved corridors are followed when they are on the way
+    // rather than searched for, which keeps the search narrow
+    auto GetHeuristic = [&](const FIntPoint& Cell, int32 Direction)
+    {
+        const FIntPoint Delta = EndCell - Cell;
+        if (Delta == FIntPoint::ZeroValue)
+        {
+            return 0;
+        }
+
+        const FIntPoint Toward(FMath::Sign(Delta.X), FMath::Sign(Delta.Y));
+        const FIntPoint& Offset = DirectionOffsets[Direction];
+
+        int32 NumBends = 0;
+        if (Delta.X == 0 || Delta.Y == 0)
+        {
+            // Straight ahead, one bend to turn towards the end or two to turn back
+            NumBends = Offset == Toward ? 0 : Offset == FIntPoint(-Toward.X, -Toward.Y) ? 2 : 1;
+        }
+        else
+        {
+            NumBends = (Offset.X == Toward.X || Offset.Y == Toward.Y) ? 1 : 2;
+        }
+
+        return (FMath::Abs(Delta.X) + FMath::Abs(Delta.Y)) * StepCost + NumBends * BendCost;
+    };
+
+    auto HeapPredicate = [](const SOpenState& A, const SOpenState& B)
+    {
+        return A.EstimatedCost < B.EstimatedCost || (A.EstimatedCost == B.EstimatedCost && A.State < B.State);
+    };
+
+    auto Visit = [&](const FIntPoint& Cell, int32 Direction, int32 Cost, int32 Parent)
+    {
+        const int32 State = GetState(Cell, Direction);
+        SSearchState& Search = States[State];
+        if (Search.Stamp == SearchStamp && Search.Cost <= Cost)
+        {
+            return;
+        }
+
+        Search.Stamp = SearchStamp;
+        Search.Cost = Cost;
+        Search.Parent = Parent;
+
+        OpenStates.HeapPush(SOpenState{ Cost + GetHeuristic(Cell, Direction), Cost, State }, HeapPredicate);
+    };
+
+    // The first move is free to go in any direction
+    OpenStates.Reset();
+    for (int32 Direction = 0; Direction < 4; Direction++)
+    {
+        Visit(StartCell, Direction, 0, INDEX_NONE);
+    }
+
+    int32 EndState = INDEX_NONE;
+    while (OpenStates.Num() > 0)
+    {
+        SOpenState Current;
+        OpenStates.HeapPop(Current, HeapPredicate, EAllowShrinking::No);
+
+        if (Current.Cost > States[Current.State].Cost)
+        {
+            continue;
+        }
+
+        const FIntPoint Cell = GetStateCell(Current.State);
+        if (Cell == EndCell)
+        {
+            EndState = Current.State;
+            break;
+        }
+
+        const int32 Direction = Current.State & 3;
+        for (int32 NextDirection = 0; NextDirection < 4; NextDirection++)
+        {
+            // Going back is never shorter
+            if (NextDirection == ((Direction + 2) & 3))
+            {
+                continue;
+            }
+
+            const FIntPoint Next = Cell + DirectionOffsets[NextDirection];
+            if (Next.X < WindowMin.X || Next.Y < WindowMin.Y || Next.X > WindowMax.X || Next.Y > WindowMax.Y)
+            {
+                continue;
+            }
+
+            const int32 Cost = Current.Cost + GetStepCost(Next) + (NextDirection != Direction ? BendCost : 0);
+            Visit(Next, NextDirection, Cost, Current.State);
+        }
+    }
+
+    // Every cell can be crossed and the window holds both ends, so the end is always reached
+    check(EndState != INDEX_NONE);
+
+    PathCells.Reset();
+    for (int32 State = EndState; State != INDEX_NONE; State = States[State].Parent)
+    {
+        PathCells.Add(GetStateCell(State));
+    }
+    Algo::Reverse(PathCells);
+
+    for (const FIntPoint& Cell : PathCells)
+    {
+        SetBit(CarvedBits, Cell.Y * NumCellsX + Cell.X);
+    }
+
+    return AddPathLines(Start, End, OutLines);
+}
+
+/**
+ * Adds the two segments of an L-shaped path, the first one horizontal
+ * @param Start - Start point
+ * @param End - End point
+ * @param OutLines - Receives the segments of the path
+ * @return Number of segments added
+ */
+int32 SCorridorRouter::AddLShapedLines(const FVector2D& Start, const FVector2D& End, TDungeonScratchArray<TPair<FVector2D, FVector2D>>& OutLines)
+{
+    const FVector2D Corner(End.X, Start.Y);
+    OutLines.Add(TPair<FVector2D, FVector2D>(Start, Corner));
+    OutLines.Add(TPair<FVector2D, FVector2D>(Corner, End));
+    return 2;
+}
+
+/**
+ * Converts the cells of the last path into segments
+ * Each straight run of cells becomes one segment through the cell centers, except that the first run
+ * is moved onto Start and the last one onto End, so the path starts and ends exactly at the room points
+ * A path made of a single run gets a jog halfway when Start and End are not aligned
+ * @param Start - Start point, in the first cell of the path
+ * @param End - End point, in the last cell of the path
+ * @param OutLines - Receives the segments of the path
+ * @return Number of segments added
+ */
+int32 SCorridorRouter::AddPathLines(const FVector2D& Start, const FVector2D& End, TDungeonScratchArray<TPair<FVector2D, FVector2D>>& OutLines) const
+{
+    // Runs are given by their orientation and their coordinate across it
+    TArray<TPair<bool, double>, TInlineAllocator<16, TMemStackAllocator<>>> Runs;
+    for (int32 i = 1; i < PathCells.Num(); i++)
+    {
+        const bool bHorizontal = PathCells[i].Y == PathCells[i - 1].Y;
+        if (Runs.Num() == 0 || Runs.Last().Key != bHorizontal)
+        {
+            const FVector2D Center = GetCellCenter(PathCells[i]);
+            Runs.Add(TPair<bool, double>(bHorizontal, bHorizontal ? Center.Y : Center.X));
+        }
+    }
+
+    Runs[0].Value = Runs[0].Key ? Start.Y : Start.X;
+
+    if (Runs.Num() == 1)
+    {
+        const double EndValue = Runs[0].Key ? End.Y : End.X;
+        if (EndValue == Runs[0].Value)
+        {
+            OutLines.Add(TPair<FVector2D, FVector2D>(Start, End));
+            return 1;
+        }
+
+        // Jog across halfway
+        const FVector2D Middle = GetCellCenter(PathCells[PathCells.Num() / 2]);
+        const FVector2D First = Runs[0].Key ? FVector2D(Middle.X, Start.Y) : FVector2D(Start.X, Middle.Y);
+        const FVector2D Second = Runs[0].Key ? FVector2D(Middle.X, End.Y) : FVector2D(End.X, Middle.Y);
+        OutLines.Add(TPair<FVector2D, FVector2D>(Start, First));
+        OutLines.Add(TPair<FVector2D, FVector2D>(First, Second));
+        OutLines.Add(TPair<FVector2D, FVector2D>(Second, End));
+        return 3;
+    }
+
+    Runs.Last().Value = Runs.Last().Key ? End.Y : End.X;
+
+    // Consecutive runs alternate orientations, each corner is where one run meets the next
+    FVector2D Previous = Start;
+    for (int32 i = 0; i + 1 < Runs.Num(); i++)
+    {
+        const FVector2D Corner = Runs[i].Key ? FVector2D(Runs[i + 1].Value, Runs[i].Value) : FVector2D(Runs[i].Value, Runs[i + 1].Value);
+        OutLines.Add(TPair<FVector2D, FVector2D>(Previous, Corner));
+        Previous = Corner;
+    }
+    OutLines.Add(TPair<FVector2D, FVector2D>(Previous, End));
+
+    return Runs.Num();
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RoomGeometry.h"
+#include "DungeonScratch.h"
+
+/**
+ * Routes corridors on a grid around the rooms they do not connect
+ * Rooms and already carved corridors are stored as one bit per cell, paths are found with A* over cells and directions
+ * Going through a room is allowed but expensive, so a route always exists and only crosses rooms when going around is much longer
+ * The grid and search state live on the memory stack, a router must not outlive the mark it was built under
+ */
+struct SCorridorRouter
+{
+public:
+    // Rasterizes the room footprints, the cell size is grown if the grid would get too large
+    void Build(TConstArrayView<SRoomFootprint> Rooms, TConstArrayView<int32> RoomIndices, double InCellSize);
+
+    // Finds the cheapest path between two rooms and appends its axis aligned segments, returns the number of segments added
+    int32 Route(const FVector2D& Start, const FBox2D& StartRoom, const FVector2D& End, const FBox2D& EndRoom, TDungeonScratchArray<TPair<FVector2D, FVector2D>>& OutLines);
+
+    double GetCellSize() const { return CellSize; }
+
+private:
+
+    // Costs of entering a cell, in thirds of a cell so carved corridors can be cheaper
+    static constexpr int32 StepCost = 3;
+    static constexpr int32 CarvedStepCost = 2;
+    static constexpr int32 RoomStepCost = 24;
+    static constexpr int32 BendCost = 8;
+
+    // Cells around the start and end cells a search may go through to get around rooms
+    static constexpr int32 MinWindowMargin = 8;
+
+    // Largest search window, in cells times directions, about 12 MB of search state
+    // Longer edges get an L-shaped corridor rather than a search
+    static constexpr int32 MaxSearchStates = 1024 * 1024;
+
+    // Free cells around the rooms, so corridors can go around the outermost rooms
+    static constexpr int32 BorderCells = 4;
+
+    static constexpr double MaxCells = 16.0 * 1024.0 * 1024.0;
+
+    /**
+     * Search data of a cell and direction, only valid when its stamp is the stamp of the current search
+     */
+    struct SSearchState
+    {
+    public:
+        uint32 Stamp = 0;
+        int32 Cost = 0;
+        int32 Parent = INDEX_NONE;
+    };
+
+    /**
+     * Entry of the open list, stale entries are skipped when popped
+     */
+    struct SOpenState
+    {
+    public:
+        int32 EstimatedCost = 0;
+        int32 Cost = 0;
+        int32 State = 0;
+    };
+
+    FIntPoint GetCell(const FVector2D& Point) const
+    {
+        return FIntPoint(
+            FMath::Clamp(FMath::FloorToInt32((Point.X - Origin.X) / CellSize), 0, NumCellsX - 1),
+            FMath::Clamp(FMath::FloorToInt32((Point.Y - Origin.Y) / CellSize), 0, NumCellsY - 1));
+    }
+
+    FVector2D GetCellCenter(const FIntPoint& Cell) const
+    {
+        return FVector2D(Origin.X + (Cell.X + 0.5) * CellSize, Origin.Y + (Cell.Y + 0.5) * CellSize);
+    }
+
+    static bool GetBit(const TDungeonScratchArray<uint32>& Bits, int32 Index) { return (Bits[Index >> 5] >> (Index & 31)) & 1u; }
+    static void SetBit(TDungeonScratchArray<uint32>& Bits, int32 Index) { Bits[Index >> 5] |= 1u << (Index & 31); }
+
+    // Adds an L-shaped path, horizontal from Start then vertical to End
+    static int32 AddLShapedLines(const FVector2D& Start, const FVector2D& End, TDungeonScratchArray<TPair<FVector2D, FVector2D>>& OutLines);
+
+    // Converts the cells of a path into segments starting and ending exactly at the given points
+    int32 AddPathLines(const FVector2D& Start, const FVector2D& End, TDungeonScratchArray<TPair<FVector2D, FVector2D>>& OutLines) const;
+
+    FVector2D Origin = FVector2D::ZeroVector;
+    double CellSize = 1.0;
+    int32 NumCellsX = 0;
+    int32 NumCellsY = 0;
+
+    // One bit per cell, cell (X, Y) being bit Y * NumCellsX + X
+    TDungeonScratchArray<uint32> RoomBits;
+    TDungeonScratchArray<uint32> CarvedBits;
+
+    // Search state over the cells of the search window times four directions
+    // Sized for the largest window so far and invalidated by bumping the stamp
+    TDungeonScratchArray<SSearchState> States;
+    uint32 SearchStamp = 0;
+    TDungeonScratchArray<SOpenState> OpenStates;
+
+    // Cells of the last path, from start to end
+    TDungeonScratchArray<FIntPoint> PathCells;
+};
@@ -0,0 +1,84 @@
+#include "DungeonActorPool.h"
+
+/**
+ * Takes a pooled actor and places it back in the world
+ * Pooled actors destroyed in the meantime, or left in another world, are dropped
+ * @param World - World the actor must live in
+ * @param Class - Exact class of the actor
+ * @param Transform - New transform of the actor, scale included
+ * @return Pooled actor ready to use, null on a miss
+ */
+AActor* UDungeonActorPool::Acquire(UWorld* World, UClass* Class, const FTransform& Transform)
+{
+    FDungeonPooledActors* Pooled = FreeActors.Find(Class);
+
+    while (Pooled && !Pooled->Actors.IsEmpty())
+    {
+        AActor* Actor = Pooled->Actors.Pop(EAllowShrinking::No);
+        Stats.NumPooled--;
+
+        if (!IsValid(Actor) || Actor->GetWorld() != World)
+        {
+            continue;
+        }
+
+        Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+        Actor->SetActorHiddenInGame(false);
+        Actor->SetActorEnableCollision(true);
+        Actor->SetActorTickEnabled(Actor->PrimaryActorTick.bStartWithTickEnabled);
+
+        if (Actor->Implements<UDungeonPooledActor>())
+        {
+            IDungeonPooledActor::Execute_OnAcquiredFromPool(Actor);
+        }
+
+        Stats.Hits++;
+        return Actor;
+    }
+
+    Stats.Misses++;
+    return nullptr;
+}
+
+/**
+ * Gives an actor back to the pool
+ * @param Actor - Actor to hide, ignored if already destroyed
+ */
+void UDungeonActorPool::Release(AActor* Actor)
+{
+    if (!IsValid(Actor))
+    {
+        return;
+    }
+
+    Actor->SetActorHiddenInGame(true);
+    Actor->SetActorEnableCollision(false);
+    Actor->SetActorTickEnabled(false);
+
+    // Lets the actor clear the state of the dungeon it belonged to
+    if (Actor->Implements<UDungeonPooledActor>())
+    {
+        IDungeonPooledActor::Execute_OnReleasedToPool(Actor);
+    }
+
+    FreeActors.FindOrAdd(Actor->GetClass()).Actors.Add(Actor);
+    Stats.Released++;
+    Stats.NumPooled++;
+}
+
+void UDungeonActorPool::Empty()
+{
+    for (TPair<TObjectPtr<UClass>, FDungeonPooledActors>& Pooled : FreeActors)
+    {
+        for (AActor* Actor : Pooled.Value.Actors)
+        {
+            if (IsValid(Actor))
+            {
+                Actor->Destroy();
+            }
+        }
+    }
+
+    FreeActors.Empty();
+    Stats.NumPooled = 0;
+}
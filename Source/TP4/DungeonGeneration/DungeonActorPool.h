@@ -0,0 +1,108 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "GameFramework/Actor.h"
+#include "UObject/Interface.h"
+#include "DungeonActorPool.generated.h"
+
+UINTERFACE(MinimalAPI, BlueprintType)
+class UDungeonPooledActor : public UInterface
+{
+    GENERATED_BODY()
+};
+
+/**
+ * Reset hooks of actors reused by the actor pool
+ * Reused actors do not run BeginPlay again, state left by the previous dungeon must be cleared here
+ */
+class TP4_API IDungeonPooledActor
+{
+    GENERATED_BODY()
+
+public:
+
+    // Called once the actor is hidden and disabled in the pool
+    UFUNCTION(BlueprintNativeEvent, Category = "Dungeon Generation")
+    void OnReleasedToPool();
+
+    // Called when the actor is taken from the pool, after it was moved and shown again
+    UFUNCTION(BlueprintNativeEvent, Category = "Dungeon Generation")
+    void OnAcquiredFromPool();
+};
+
+/**
+ * Hidden actors of one class waiting to be reused
+ */
+USTRUCT()
+struct FDungeonPooledActors
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY()
+    TArray<TObjectPtr<AActor>> Actors;
+};
+
+/**
+ * Counters of the actor pool since its creation
+ */
+USTRUCT(BlueprintType)
+struct FDungeonActorPoolStats
+{
+    GENERATED_BODY()
+
+public:
+    // Actors taken from the pool instead of being spawned
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 Hits = 0;
+
+    // Requests the pool could not serve, the caller spawned a new actor
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 Misses = 0;
+
+    // Actors given back to the pool
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 Released = 0;
+
+    // Actors currently hidden in the pool
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 NumPooled = 0;
+};
+
+/**
+ * Per class pool of room and corridor actors
+ * Released actors are hidden and disabled instead of destroyed, then moved and shown again when acquired
+ * Reused actors do not run BeginPlay again, actors implementing IDungeonPooledActor are notified instead
+ */
+UCLASS()
+class TP4_API UDungeonActorPool : public UObject
+{
+    GENERATED_BODY()
+
+public:
+
+    // Takes an actor of exactly this class living in World, null if none is pooled
+    AActor* Acquire(UWorld* World, UClass* Class, const FTransform& Transform);
+
+    template<typename ActorType>
+    ActorType* Acquire(UWorld* World, TSubclassOf<ActorType> Class, const FTransform& Transform)
+    {
+        return Cast<ActorType>(Acquire(World, Class.Get(), Transform));
+    }
+
+    // Hides and disables an actor until it is acquired again
+    void Release(AActor* Actor);
+
+    // Destroys every pooled actor
+    void Empty();
+
+    const FDungeonActorPoolStats& GetStats() const { return Stats; }
+
+private:
+
+    UPROPERTY()
+    TMap<TObjectPtr<UClass>, FDungeonPooledActors> FreeActors;
+
+    FDungeonActorPoolStats Stats;
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformTLS.h"
+#include <atomic>
+
+/**
+ * Forwards every allocation to the engine allocator and counts them
+ * Meant to be installed as GMalloc only around the code being measured, the benchmark commandlet and the automation tests use it
+ * Allocations of every thread are counted unless CountedThreadId is set
+ */
+class FCountingMalloc final : public FMalloc
+{
+public:
+    explicit FCountingMalloc(FMalloc* InInner) : Inner(InInner) {}
+
+    virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+    {
+        void* Result = Inner->Malloc(Count, Alignment);
+        OnAllocated(Result);
+        return Result;
+    }
+
+    virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+    {
+        void* Result = Inner->TryMalloc(Count, Alignment);
+        OnAllocated(Result);
+        return Result;
+    }
+
+    virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+    {
+        if (!IsCountedThread())
+        {
+            return Inner->Realloc(Original, Count, Alignment);
+        }
+
+        const int64 OldSize = GetSize(Original);
+        void* Result = Inner->Realloc(Original, Count, Alignment);
+        if (Result)
+        {
+            NumAllocations.fetch_add(1, std::memory_order_relaxed);
+            const int64 NewSize = GetSize(Result);
+            AllocatedBytes.fetch_add(NewSize, std::memory_order_relaxed);
+            UpdateLiveBytes(NewSize - OldSize);
+        }
+        else
+        {
+            UpdateLiveBytes(-OldSize);
+        }
+        return Result;
+    }
+
+    virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+    {
+        return Realloc(Original, Count, Alignment);
+    }
+
+    virtual void Free(void* Original) override
+    {
+        if (IsCountedThread())
+        {
+            UpdateLiveBytes(-GetSize(Original));
+        }
+        Inner->Free(Original);
+    }
+
+    virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+    virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+    virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+    virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+    virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+    virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+    virtual const TCHAR* GetDescriptiveName() override { return TEXT("DungeonCountingMalloc"); }
+
+    // Starts counting from zero, the peak is measured from the live bytes at this point
+    void Reset()
+    {
+        NumAllocations = 0;
+        AllocatedBytes = 0;
+        LiveBytes = 0;
+        PeakBytes = 0;
+    }
+
+    FMalloc* Inner;
+    std::atomic<int64> NumAllocations{ 0 };
+    std::atomic<int64> AllocatedBytes{ 0 };
+    std::atomic<int64> LiveBytes{ 0 };
+    std::atomic<int64> PeakBytes{ 0 };
+
+    // Only counts the allocations of this thread when not 0, so other threads allocating meanwhile are left out
+    uint32 CountedThreadId = 0;
+
+private:
+    bool IsCountedThread() const
+    {
+        return CountedThreadId == 0 || CountedThreadId == FPlatformTLS::GetCurrentThreadId();
+    }
+
+    int64 GetSize(void* Pointer)
+    {
+        SIZE_T Size = 0;
+        return Pointer && Inner->GetAllocationSize(Pointer, Size) ? static_cast<int64>(Size) : 0;
+    }
+
+    void OnAllocated(void* Result)
+    {
+        if (Result && IsCountedThread())
+        {
+            const int64 Size = GetSize(Result);
+            NumAllocations.fetch_add(1, std::memory_order_relaxed);
+            AllocatedBytes.fetch_add(Size, std::memory_order_relaxed);
+            UpdateLiveBytes(Size);
+        }
+    }
+
+    void UpdateLiveBytes(int64 Delta)
+    {
+        const int64 Live = LiveBytes.fetch_add(Delta, std::memory_order_relaxed) + Delta;
+        int64 Peak = PeakBytes.load(std::memory_order_relaxed);
+        while (Live > Peak && !PeakBytes.compare_exchange_weak(Peak, Live, std::memory_order_relaxed))
+        {
+        }
+    }
+};
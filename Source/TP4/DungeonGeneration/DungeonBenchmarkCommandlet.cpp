@@ -0,0 +1,380 @@
+#include "DungeonBenchmarkCommandlet.h"
+#include "TP4.h"
+#include "Triangulation.h"
+#include "MinSpanTree.h"
+#include "DungeonLayoutGenerator.h"
+#include "CorridorMerging.h"
+#include "DungeonAllocationCounter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace DungeonBenchmark
+{
+    /**
+     * Measurements of one stage on one point set
+     */
+    struct SResult
+    {
+    public:
+        FString Stage;
+        FString Distribution;
+        int32 NumPoints = 0;
+        int32 Iterations = 0;
+        double MinTimeMs = 0.0;
+        double MedianTimeMs = 0.0;
+        // Allocations of the first run, buffers and memory stack pages being created cold
+        int64 FirstAllocations = 0;
+        int64 Allocations = 0;
+        int64 AllocatedBytes = 0;
+        int64 PeakBytes = 0;
+    };
+
+    TArray<FVector2D> MakeUniformPoints(int32 NumPoints, FRandomStream& Stream)
+    {
+        const double Extent = FMath::Sqrt(static_cast<double>(NumPoints)) * 1000.0;
+
+        TArray<FVector2D> Points;
+        Points.Reserve(NumPoints);
+        for (int32 i = 0; i < NumPoints; i++)
+        {
+            Points.Add(FVector2D(Stream.FRandRange(0.f, 1.f) * Extent, Stream.FRandRange(0.f, 1.f) * Extent));
+        }
+        return Points;
+    }
+
+    // Gaussian blobs around 16 random centers
+    TArray<FVector2D> MakeClusteredPoints(int32 NumPoints, FRandomStream& Stream)
+    {
+        const double Extent = FMath::Sqrt(static_cast<double>(NumPoints)) * 1000.0;
+        const double Sigma = Extent / 40.0;
+
+        TArray<FVector2D> Centers;
+        for (int32 i = 0; i < 16; i++)
+        {
+            Centers.Add(FVector2D(Stream.FRandRange(0.f, 1.f) * Extent, Stream.FRandRange(0.f, 1.f) * Extent));
+        }
+
+        TArray<FVector2D> Points;
+        Points.Reserve(NumPoints);
+        for (int32 i = 0; i < NumPoints; i++)
+        {
+            // Box-Muller transform
+            const double Radius = Sigma * FMath::Sqrt(-2.0 * FMath::Loge(FMath::Max(Stream.GetFraction(), UE_SMALL_NUMBER)));
+            const double Angle = UE_TWO_PI * Stream.GetFraction();
+            Points.Add(Centers[i % Centers.Num()] + FVector2D(Radius * FMath::Cos(Angle), Radius * FMath::Sin(Angle)));
+        }
+        return Points;
+    }
+
+    // Points on an integer grid, every cell being a cocircular quad
+    TArray<FVector2D> MakeGridPoints(int32 NumPoints)
+    {
+        const int32 Side = FMath::CeilToInt32(FMath::Sqrt(static_cast<double>(NumPoints)));
+
+        TArray<FVector2D> Points;
+        Points.Reserve(NumPoints);
+        for (int32 i = 0; i < NumPoints; i++)
+        {
+            Points.Add(FVector2D((i % Side) * 1000.0, (i / Side) * 1000.0));
+        }
+        return Points;
+    }
+
+    // Sum of the MST edge lengths, compared between precisions
+    double GetTreeLength(const SDungeonMesh& Mesh, const TArray<int32>& MST)
+    {
+        double Length = 0.0;
+        for (int32 EdgeIndex : MST)
+        {
+            Length += FMath::Sqrt(Mesh.GetEdgeLengthSquared(EdgeIndex));
+        }
+        return Length;
+    }
+
+    /**
+     * Runs a stage several times and keeps the minimum and median times
+     * Allocations are those of the last run, the stage being deterministic, and of the first run
+     * Stages reusing their outputs and the memory stack only allocate on the first run
+     */
+    template<typename FuncType>
+    SResult RunStage(FCountingMalloc& Counter, const TCHAR* Stage, const TCHAR* Distribution, int32 NumPoints, int32 Iterations, FuncType&& Func)
+    {
+        SResult Result;
+        Result.Stage = Stage;
+        Result.Distribution = Distribution;
+        Result.NumPoints = NumPoints;
+        Result.Iterations = Iterations;
+
+        TArray<double> Times;
+        for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+        {
+            FMalloc* PreviousMalloc = GMalloc;
+            Counter.Reset();
+            GMalloc = &Counter;
+
+            const double StartTime = FPlatformTime::Seconds();
+            Func();
+            const double EndTime = FPlatformTime::Seconds();
+
+            GMalloc = PreviousMalloc;
+
+            Times.Add((EndTime - StartTime) * 1000.0);
+            if (Iteration == 0)
+            {
+                Result.FirstAllocations = Counter.NumAllocations;
+            }
+            Result.Allocations = Counter.NumAllocations;
+            Result.AllocatedBytes = Counter.AllocatedBytes;
+            Result.PeakBytes = Counter.PeakBytes;
+        }
+
+        Times.Sort();
+        Result.MinTimeMs = Times[0];
+        Result.MedianTimeMs = Times[Times.Num() / 2];
+        return Result;
+    }
+}
+
+UDungeonBenchmarkCommandlet::UDungeonBenchmarkCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = false;
+    LogToConsole = true;
+}
+
+int32 UDungeonBenchmarkCommandlet::Main(const FString& Params)
+{
+    using namespace DungeonBenchmark;
+
+    // Read the options
+    TArray<int32> Sizes = { 100, 1000, 10000, 100000 };
+    FString SizesString;
+    if (FParse::Value(*Params, TEXT("Sizes="), SizesString))
+    {
+        TArray<FString> SizeStrings;
+        SizesString.ParseIntoArray(SizeStrings, TEXT(","));
+        Sizes.Reset();
+        for (const FString& Size : SizeStrings)
+        {
+            Sizes.Add(FCString::Atoi(*Size));
+        }
+    }
+
+    int32 Iterations = 5;
+    FParse::Value(*Params, TEXT("Iterations="), Iterations);
+    Iterations = FMath::Max(1, Iterations);
+
+    // Bowyer-Watson is only kept as a reference, it gets too slow on the largest sets
+    int32 MaxBowyerWatsonPoints = 20000;
+    FParse::Value(*Params, TEXT("MaxBowyerWatsonPoints="), MaxBowyerWatsonPoints);
+
+    // Full layouts separate their rooms, which is much slower than the other stages
+    int32 MaxLayoutRooms = 10000;
+    FParse::Value(*Params, TEXT("MaxLayoutRooms="), MaxLayoutRooms);
+
+    FString OutputDir = FPaths::ProjectSavedDir() / TEXT("Benchmarks");
+    FParse::Value(*Params, TEXT("Output="), OutputDir);
+
+    FCountingMalloc Counter(GMalloc);
+    TArray<SResult> Results;
+
+    const TCHAR* Distributions[] = { TEXT("Uniform"), TEXT("Clustered"), TEXT("Grid") };
+
+    for (int32 NumPoints : Sizes)
+    {
+        for (int32 DistributionIndex = 0; DistributionIndex < static_cast<int32>(UE_ARRAY_COUNT(Distributions)); DistributionIndex++)
+        {
+            const TCHAR* Distribution = Distributions[DistributionIndex];
+
+            FRandomStream Stream(NumPoints);
+            const TArray<FVector2D> Points = DistributionIndex == 0 ? MakeUniformPoints(NumPoints, Stream)
+                                           : DistributionIndex == 1 ? MakeClusteredPoints(NumPoints, Stream)
+                                           : MakeGridPoints(NumPoints);
+
+            const int32 FirstResult = Results.Num();
+
+            SDungeonMesh Mesh;
+            Results.Add(RunStage(Counter, TEXT("Triangulation.Incremental"), Distribution, NumPoints, Iterations, [&]()
+            {
+                UTriangulation::GenerateMesh(Points, Mesh);
+            }));
+
+            if (NumPoints <= MaxBowyerWatsonPoints)
+            {
+                Results.Add(RunStage(Counter, TEXT("Triangulation.BowyerWatson"), Distribution, NumPoints, Iterations, [&]()
+                {
+                    UTriangulation::GenerateTriangulationBowyerWatson(Points);
+                }));
+            }
+
+            TArray<int32> MST;
+            Results.Add(RunStage(Counter, TEXT("MST.Kruskal"), Distribution, NumPoints, Iterations, [&]()
+            {
+                UMinSpanTree::GenerateMST(Mesh, MST, EMSTAlgorithm::Kruskal);
+            }));
+
+            TArray<int32> PrimMST;
+            Results.Add(RunStage(Counter, TEXT("MST.Prim"), Distribution, NumPoints, Iterations, [&]()
+            {
+                UMinSpanTree::GenerateMST(Mesh, PrimMST, EMSTAlgorithm::Prim);
+            }));
+
+            // Same triangulation and MST with the other precisions, the double ones above being the reference
+            const EGeometryPrecision Precisions[] = { EGeometryPrecision::Float, EGeometryPrecision::Fixed };
+            const TCHAR* PrecisionNames[] = { TEXT("Float"), TEXT("Fixed") };
+            for (int32 PrecisionIndex = 0; PrecisionIndex < static_cast<int32>(UE_ARRAY_COUNT(Precisions)); PrecisionIndex++)
+            {
+                const EGeometryPrecision Precision = Precisions[PrecisionIndex];
+
+                SDungeonMesh PrecisionMesh;
+                const FString TriangulationStage = FString::Printf(TEXT("Triangulation.Incremental.%s"), PrecisionNames[PrecisionIndex]);
+                Results.Add(RunStage(Counter, *TriangulationStage, Distribution, NumPoints, Iterations, [&]()
+                {
+                    UTriangulation::GenerateMesh(Points, PrecisionMesh, Precision);
+                }));
+
+                TArray<int32> PrecisionMST;
+                const FString MSTStage = FString::Printf(TEXT("MST.Kruskal.%s"), PrecisionNames[PrecisionIndex]);
+                Results.Add(RunStage(Counter, *MSTStage, Distribution, NumPoints, Iterations, [&]()
+                {
+                    UMinSpanTree::GenerateMST(PrecisionMesh, PrecisionMST, EMSTAlgorithm::Kruskal, Precision);
+                }));
+
+                UE_LOG(LogDungeon, Display, TEXT("%-28s %-10s %7d points: %d triangles and MST length %.1f, double gives %d and %.1f"),
+                    *TriangulationStage, Distribution, NumPoints, PrecisionMesh.NumTriangles(), GetTreeLength(PrecisionMesh, PrecisionMST), Mesh.NumTriangles(), GetTreeLength(Mesh, MST));
+            }
+
+            Results.Add(RunStage(Counter, TEXT("CorridorLines"), Distribution, NumPoints, Iterations, [&]()
+            {
+                FMemMark Mark(FMemStack::Get());
+                TDungeonScratchArray<TPair<FVector2D, FVector2D>> Lines;
+                FRandomStream CorridorStream(NumPoints);
+                UDungeonLayoutGenerator::GenerateCorridorLines(Mesh, MST, CorridorStream, Lines);
+            }));
+
+            // Each iteration merges a fresh copy of the L-shaped segments, the copy is part of the counted allocations
+            TArray<FDungeonCorridorSegment> CorridorSegments;
+            {
+                FMemMark Mark(FMemStack::Get());
+                TDungeonScratchArray<TPair<FVector2D, FVector2D>> Lines;
+                FRandomStream MergeStream(NumPoints);
+                UDungeonLayoutGenerator::GenerateCorridorLines(Mesh, MST, MergeStream, Lines);
+                for (const TPair<FVector2D, FVector2D>& Line : Lines)
+                {
+                    FDungeonCorridorSegment& Segment = CorridorSegments.AddDefaulted_GetRef();
+                    Segment.Start = Line.Key;
+                    Segment.End = Line.Value;
+                }
+            }
+
+            TArray<FDungeonCorridorSegment> MergedSegments;
+            TArray<FDungeonCorridorJunction> Junctions;
+            Results.Add(RunStage(Counter, TEXT("CorridorMerging"), Distribution, NumPoints, Iterations, [&]()
+            {
+                MergedSegments = CorridorSegments;
+                UCorridorMerging::MergeCorridors(MergedSegments);
+                UCorridorMerging::FindJunctions(MergedSegments, Junctions);
+            }));
+
+            UE_LOG(LogDungeon, Display, TEXT("%-28s %-10s %7d points: %d segments merged into %d with %d junctions"),
+                TEXT("CorridorMerging"), Distribution, NumPoints, CorridorSegments.Num(), MergedSegments.Num(), Junctions.Num());
+
+            // One room per point, small enough for uniform and grid points to leave room for corridors between them
+            TArray<SRoomFootprint> Rooms;
+            TArray<int32> RoomIndices;
+            Rooms.Reserve(NumPoints);
+            RoomIndices.Reserve(NumPoints);
+            for (int32 i = 0; i < NumPoints; i++)
+            {
+                SRoomFootprint& Room = Rooms.AddDefaulted_GetRef();
+                Room.Location = Points[i];
+                Room.Extent = FVector2D(250.0, 200.0);
+                RoomIndices.Add(i);
+            }
+
+            TArray<int32> PathSegments;
+            Results.Add(RunStage(Counter, TEXT("CorridorRouting"), Distribution, NumPoints, Iterations, [&]()
+            {
+                FMemMark Mark(FMemStack::Get());
+                TDungeonScratchArray<TPair<FVector2D, FVector2D>> Lines;
+                UDungeonLayoutGenerator::RouteCorridorLines(Mesh, MST, Rooms, RoomIndices, RoomIndices, 100.0, Lines, PathSegments);
+            }));
+
+            // Whole generations into the same layout, only the first one should allocate
+            // Rooms are placed at random, so the layout does not depend on the distribution and only runs once per size
+            if (DistributionIndex == 0 && NumPoints <= MaxLayoutRooms)
+            {
+                SDungeonLayoutParams LayoutParams;
+                LayoutParams.Seed = NumPoints;
+                LayoutParams.RoomFootprints.AddDefaulted_GetRef().Extent = FVector2D(250.0, 200.0);
+                LayoutParams.RoomFootprints.AddDefaulted_GetRef().Extent = FVector2D(400.0, 300.0);
+                LayoutParams.RoomCount = NumPoints;
+                LayoutParams.Bounds = FVector2D(FMath::Sqrt(static_cast<double>(NumPoints)) * 500.0);
+
+                FDungeonLayout Layout;
+                Results.Add(RunStage(Counter, TEXT("Layout"), TEXT("Random"), NumPoints, Iterations, [&]()
+                {
+                    UDungeonLayoutGenerator::GenerateLayout(LayoutParams, Layout);
+                }));
+            }
+
+            for (int32 i = FirstResult; i < Results.Num(); i++)
+            {
+                const SResult& Result = Results[i];
+                UE_LOG(LogDungeon, Display, TEXT("%-28s %-10s %7d points: min %10.3f ms, median %10.3f ms, %8lld allocations (%lld first run), %12lld bytes, peak %12lld bytes"),
+                    *Result.Stage, *Result.Distribution, Result.NumPoints, Result.MinTimeMs, Result.MedianTimeMs, Result.Allocations, Result.FirstAllocations, Result.AllocatedBytes, Result.PeakBytes);
+            }
+        }
+    }
+
+    // Write the results as CSV
+    FString Csv = TEXT("Stage,Distribution,NumPoints,Iterations,MinTimeMs,MedianTimeMs,FirstAllocations,Allocations,AllocatedBytes,PeakBytes\n");
+    for (const SResult& Result : Results)
+    {
+        Csv += FString::Printf(TEXT("%s,%s,%d,%d,%.4f,%.4f,%lld,%lld,%lld,%lld\n"),
+            *Result.Stage, *Result.Distribution, Result.NumPoints, Result.Iterations, Result.MinTimeMs, Result.MedianTimeMs, Result.FirstAllocations, Result.Allocations, Result.AllocatedBytes, Result.PeakBytes);
+    }
+
+    // Write the results as JSON, with the platform so runs from different machines can be told apart
+    TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+    Root->SetStringField(TEXT("Platform"), FPlatformProperties::IniPlatformName());
+    Root->SetStringField(TEXT("Cpu"), FPlatformMisc::GetCPUBrand());
+    Root->SetNumberField(TEXT("ProcessPeakUsedPhysical"), static_cast<double>(FPlatformMemory::GetStats().PeakUsedPhysical));
+
+    TArray<TSharedPtr<FJsonValue>> JsonResults;
+    for (const SResult& Result : Results)
+    {
+        TSharedRef<FJsonObject> JsonResult = MakeShared<FJsonObject>();
+        JsonResult->SetStringField(TEXT("Stage"), Result.Stage);
+        JsonResult->SetStringField(TEXT("Distribution"), Result.Distribution);
+        JsonResult->SetNumberField(TEXT("NumPoints"), Result.NumPoints);
+        JsonResult->SetNumberField(TEXT("Iterations"), Result.Iterations);
+        JsonResult->SetNumberField(TEXT("MinTimeMs"), Result.MinTimeMs);
+        JsonResult->SetNumberField(TEXT("MedianTimeMs"), Result.MedianTimeMs);
+        JsonResult->SetNumberField(TEXT("FirstAllocations"), static_cast<double>(Result.FirstAllocations));
+        JsonResult->SetNumberField(TEXT("Allocations"), static_cast<double>(Result.Allocations));
+        JsonResult->SetNumberField(TEXT("AllocatedBytes"), static_cast<double>(Result.AllocatedBytes));
+        JsonResult->SetNumberField(TEXT("PeakBytes"), static_cast<double>(Result.PeakBytes));
+        JsonResults.Add(MakeShared<FJsonValueObject>(JsonResult));
+    }
+    Root->SetArrayField(TEXT("Results"), JsonResults);
+
+    FString Json;
+    const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+    FJsonSerializer::Serialize(Root, Writer);
+
+    const FString CsvPath = OutputDir / TEXT("DungeonBenchmark.csv");
+    const FString JsonPath = OutputDir / TEXT("DungeonBenchmark.json");
+    if (!FFileHelper::SaveStringToFile(Csv, *CsvPath) || !FFileHelper::SaveStringToFile(Json, *JsonPath))
+    {
+        UE_LOG(LogDungeon, Error, TEXT("Failed to write the benchmark results to %s"), *OutputDir);
+        return 1;
+    }
+
+    UE_LOG(LogDungeon, Display, TEXT("Benchmark results written to %s and %s"), *CsvPath, *JsonPath);
+    return 0;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DungeonBenchmarkCommandlet.generated.h"
+
+/**
+ * Measures the generation stages in isolation on synthetic point sets
+ * Run with: UnrealEditor-Cmd TP4.uproject -run=DungeonBenchmark [-Sizes=100,1000,10000,100000] [-Iterations=5]
+ *           [-MaxBowyerWatsonPoints=20000] [-Output=Dir]
+ * Writes DungeonBenchmark.csv and DungeonBenchmark.json, in Saved/Benchmarks by default
+ */
+UCLASS()
+class TP4_API UDungeonBenchmarkCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UDungeonBenchmarkCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
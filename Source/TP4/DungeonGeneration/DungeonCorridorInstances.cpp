@@ -0,0 +1,90 @@
+#include "DungeonCorridorInstances.h"
+
+ADungeonCorridorInstances::ADungeonCorridorInstances()
+{
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+/**
+ * Creates the instanced mesh components from the corridor class default objects
+ * @param CorridorClasses - Corridor types the layout was generated with
+ */
+void ADungeonCorridorInstances::Initialize(const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses)
+{
+	InstanceComponents.Init(nullptr, CorridorClasses.Num());
+	MeshTransforms.Init(FTransform::Identity, CorridorClasses.Num());
+
+	for (int32 i = 0; i < CorridorClasses.Num(); i++)
+	{
+		const ACorridorBase* DefaultCorridor = CorridorClasses[i] ? CorridorClasses[i]->GetDefaultObject<ACorridorBase>() : nullptr;
+		if (!DefaultCorridor || !DefaultCorridor->InstancedMesh)
+		{
+			continue;
+		}
+
+		UHierarchicalInstancedStaticMeshComponent* Component = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+		Component->SetStaticMesh(DefaultCorridor->InstancedMesh);
+		Component->SetupAttachment(RootComponent);
+		Component->RegisterComponent();
+		AddInstanceComponent(Component);
+
+		InstanceComponents[i] = Component;
+		MeshTransforms[i] = DefaultCorridor->InstancedMeshTransform;
+	}
+}
+
+bool ADungeonCorridorInstances::IsInstanced(int32 ClassIndex) const
+{
+	return InstanceComponents.IsValidIndex(ClassIndex) && InstanceComponents[ClassIndex] != nullptr;
+}
+
+/**
+ * Adds corridor segments as instances, all at once so the instance tree is rebuilt only once
+ * @param ClassIndex - Corridor class of the segments
+ * @param CorridorTransforms - World transform of each corridor segment
+ */
+void ADungeonCorridorInstances::AddInstances(int32 ClassIndex, const TArray<FTransform>& CorridorTransforms)
+{
+	if (!IsInstanced(ClassIndex) || CorridorTransforms.IsEmpty())
+	{
+		return;
+	}
+
+	// Place the mesh inside each corridor like the corridor actor would
+	TArray<FTransform> InstanceTransforms;
+	InstanceTransforms.Reserve(CorridorTransforms.Num());
+	for (const FTransform& CorridorTransform : CorridorTransforms)
+	{
+		InstanceTransforms.Add(MeshTransforms[ClassIndex] * CorridorTransform);
+	}
+
+	InstanceComponents[ClassIndex]->AddInstances(InstanceTransforms, false, true);
+}
+
+void ADungeonCorridorInstances::ClearInstances(int32 ClassIndex)
+{
+	if (IsInstanced(ClassIndex))
+	{
+		InstanceComponents[ClassIndex]->ClearInstances();
+	}
+}
+
+int32 ADungeonCorridorInstances::GetInstanceCount() const
+{
+	int32 Count = 0;
+	for (const UHierarchicalInstancedStaticMeshComponent* Component : InstanceComponents)
+	{
+		if (Component)
+		{
+			Count += Component->GetInstanceCount();
+		}
+	}
+	return Count;
+}
+
+int32 ADungeonCorridorInstances::GetComponentCount() const
+{
+	return GetComponents().Num();
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "CorridorBase.h"
+#include "DungeonCorridorInstances.generated.h"
+
+/**
+ * Renders the corridors of a dungeon as instances, one instanced mesh component per corridor class
+ * Replaces one corridor actor per segment for corridor classes with an InstancedMesh
+ */
+UCLASS()
+class TP4_API ADungeonCorridorInstances : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ADungeonCorridorInstances();
+
+	// Creates one component per corridor class that has an instanced mesh
+	void Initialize(const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses);
+
+	// Whether segments of this corridor class are rendered as instances
+	bool IsInstanced(int32 ClassIndex) const;
+
+	// Adds segments of one corridor class, transforms being the ones a spawned corridor actor would have
+	void AddInstances(int32 ClassIndex, const TArray<FTransform>& CorridorTransforms);
+
+	// Removes every instance of one corridor class
+	void ClearInstances(int32 ClassIndex);
+
+	int32 GetInstanceCount() const;
+
+	int32 GetComponentCount() const;
+
+private:
+
+	// Indexed like the corridor classes, null for classes spawned as actors
+	UPROPERTY()
+	TArray<TObjectPtr<UHierarchicalInstancedStaticMeshComponent>> InstanceComponents;
+
+	// Mesh transform relative to the corridor, per corridor class
+	TArray<FTransform> MeshTransforms;
+
+};
@@ -0,0 +1,72 @@
+#include "DungeonDebugDraw.h"
+
+ADungeonDebugDraw::ADungeonDebugDraw()
+{
+	LineBatcher = CreateDefaultSubobject<ULineBatchComponent>(TEXT("LineBatcher"));
+	RootComponent = LineBatcher;
+
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+void ADungeonDebugDraw::SetLayerLines(EDungeonDebugLayer Layer, TArray<FBatchedLine>&& Lines)
+{
+	LayerLines[static_cast<int32>(Layer)] = MoveTemp(Lines);
+
+	if (IsLayerVisible(Layer))
+	{
+		SubmitLines();
+	}
+}
+
+void ADungeonDebugDraw::SetLayerVisible(EDungeonDebugLayer Layer, bool bVisible)
+{
+	if (IsLayerVisible(Layer) == bVisible)
+	{
+		return;
+	}
+
+	LayerVisible[static_cast<int32>(Layer)] = bVisible;
+	SubmitLines();
+}
+
+bool ADungeonDebugDraw::IsLayerVisible(EDungeonDebugLayer Layer) const
+{
+	return LayerVisible[static_cast<int32>(Layer)];
+}
+
+void ADungeonDebugDraw::ClearLayers()
+{
+	for (TArray<FBatchedLine>& Lines : LayerLines)
+	{
+		Lines.Empty();
+	}
+
+	SubmitLines();
+}
+
+int32 ADungeonDebugDraw::GetLineCount() const
+{
+	int32 NumLines = 0;
+	for (int32 Layer = 0; Layer < static_cast<int32>(EDungeonDebugLayer::Num); Layer++)
+	{
+		NumLines += LayerVisible[Layer] ? LayerLines[Layer].Num() : 0;
+	}
+	return NumLines;
+}
+
+/**
+ * Replaces the lines of the line batch component by the lines of the visible layers
+ * The component only rebuilds its render data once per frame, however many layers are submitted
+ */
+void ADungeonDebugDraw::SubmitLines()
+{
+	LineBatcher->Flush();
+
+	for (int32 Layer = 0; Layer < static_cast<int32>(EDungeonDebugLayer::Num); Layer++)
+	{
+		if (LayerVisible[Layer] && LayerLines[Layer].Num() > 0)
+		{
+			LineBatcher->DrawLines(LayerLines[Layer]);
+		}
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Components/LineBatchComponent.h"
+#include "DungeonDebugDraw.generated.h"
+
+/**
+ * Debug visualization layers of a dungeon
+ */
+UENUM(BlueprintType)
+enum class EDungeonDebugLayer : uint8
+{
+	// Area rooms were initially placed in
+	Bounds,
+	// Delaunay triangulation of the room positions
+	Triangulation,
+	// Minimum spanning tree of the triangulation
+	MST,
+	// Final corridor paths
+	Corridors,
+	// T-junctions and crossings of merged corridors
+	Junctions,
+
+	Num UMETA(Hidden)
+};
+
+/**
+ * Draws the debug layers of a dungeon with a single line batch component
+ * Lines are kept per layer, so a layer can be replaced or hidden without resubmitting the others
+ * Only spawned in builds with debug drawing
+ */
+UCLASS(NotPlaceable, Transient)
+class TP4_API ADungeonDebugDraw : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ADungeonDebugDraw();
+
+	// Replaces the lines of a layer
+	void SetLayerLines(EDungeonDebugLayer Layer, TArray<FBatchedLine>&& Lines);
+
+	void SetLayerVisible(EDungeonDebugLayer Layer, bool bVisible);
+
+	bool IsLayerVisible(EDungeonDebugLayer Layer) const;
+
+	// Removes the lines of every layer, layers keep their visibility
+	void ClearLayers();
+
+	// Number of lines of the visible layers
+	int32 GetLineCount() const;
+
+private:
+
+	// Submits the lines of the visible layers again, one batch per layer
+	void SubmitLines();
+
+	UPROPERTY()
+	TObjectPtr<ULineBatchComponent> LineBatcher;
+
+	TArray<FBatchedLine> LayerLines[static_cast<int32>(EDungeonDebugLayer::Num)];
+	bool LayerVisible[static_cast<int32>(EDungeonDebugLayer::Num)] = {};
+
+};
@@ -0,0 +1,50 @@
+#include "DungeonGenerationHandle.h"
+#include "Async/Async.h"
+
+/**
+ * Runs the layout generation on a worker thread
+ * The result is handed back to the game thread, where the handle is only accessed
+ * @param Params - Generation inputs, read from the room classes on the game thread beforehand
+ */
+void UDungeonGenerationHandle::Start(SDungeonLayoutParams Params)
+{
+    Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [WeakThis = TWeakObjectPtr<UDungeonGenerationHandle>(this), Params = MoveTemp(Params), CancelFlag = CancelFlag]() mutable
+    {
+        Params.CancelFlag = &CancelFlag.Get();
+
+        FDungeonLayout GeneratedLayout;
+        const bool bSucceeded = UDungeonLayoutGenerator::GenerateLayout(Params, GeneratedLayout);
+
+        AsyncTask(ENamedThreads::GameThread, [WeakThis, bSucceeded, GeneratedLayout = MoveTemp(GeneratedLayout)]() mutable
+        {
+            if (UDungeonGenerationHandle* Handle = WeakThis.Get())
+            {
+                Handle->OnGenerationFinished(bSucceeded, MoveTemp(GeneratedLayout));
+            }
+        });
+    });
+}
+
+void UDungeonGenerationHandle::Cancel()
+{
+    CancelFlag->store(true, std::memory_order_relaxed);
+}
+
+/**
+ * Called on the game thread when the worker task is done
+ * @param bSucceeded - Whether the generation ran to the end
+ * @param GeneratedLayout - Generated layout, incomplete if the generation did not succeed
+ */
+void UDungeonGenerationHandle::OnGenerationFinished(bool bSucceeded, FDungeonLayout&& GeneratedLayout)
+{
+    bComplete = true;
+
+    // A cancel request may have arrived after the last stage
+    if (!bSucceeded || IsCancelled())
+    {
+        return;
+    }
+
+    Layout = MoveTemp(GeneratedLayout);
+    OnLayoutGenerated.Broadcast(Layout);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "Tasks/Task.h"
+#include "DungeonLayout.h"
+#include "DungeonLayoutGenerator.h"
+#include "DungeonGenerationHandle.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDungeonLayoutGenerated, const FDungeonLayout&, Layout);
+
+/**
+ * Tracks a layout generation running on worker threads
+ * OnLayoutGenerated is broadcast on the game thread once the layout is ready to materialize
+ */
+UCLASS(BlueprintType)
+class TP4_API UDungeonGenerationHandle : public UObject
+{
+    GENERATED_BODY()
+
+public:
+
+    // Launches the generation, the parameters must only hold plain data
+    void Start(SDungeonLayoutParams Params);
+
+    /** Stops the generation at the next stage boundary, OnLayoutGenerated is then never broadcast */
+    UFUNCTION(BlueprintCallable, Category = "Dungeon Generation")
+    void Cancel();
+
+    /** Whether the generation finished, successfully or not */
+    UFUNCTION(BlueprintPure, Category = "Dungeon Generation")
+    bool IsComplete() const { return bComplete; }
+
+    UFUNCTION(BlueprintPure, Category = "Dungeon Generation")
+    bool IsCancelled() const { return CancelFlag->load(std::memory_order_relaxed); }
+
+    /** Generated layout, only valid once complete and not cancelled */
+    UFUNCTION(BlueprintPure, Category = "Dungeon Generation")
+    const FDungeonLayout& GetLayout() const { return Layout; }
+
+    UPROPERTY(BlueprintAssignable, Category = "Dungeon Generation")
+    FOnDungeonLayoutGenerated OnLayoutGenerated;
+
+private:
+
+    void OnGenerationFinished(bool bSucceeded, FDungeonLayout&& GeneratedLayout);
+
+    // Shared with the worker task, which may outlive the handle
+    TSharedRef<std::atomic<bool>, ESPMode::ThreadSafe> CancelFlag = MakeShared<std::atomic<bool>, ESPMode::ThreadSafe>(false);
+
+    UE::Tasks::FTask Task;
+
+    FDungeonLayout Layout;
+
+    bool bComplete = false;
+};
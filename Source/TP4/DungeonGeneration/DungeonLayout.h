@@ -0,0 +1,263 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonMesh.h"
+#include "DungeonLayout.generated.h"
+
+/**
+ * Straight corridor piece between two points of the dungeon plane
+ */
+USTRUCT(BlueprintType)
+struct FDungeonCorridorSegment
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    FVector2D Start = FVector2D::ZeroVector;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    FVector2D End = FVector2D::ZeroVector;
+
+    // Index in the corridor classes given to the generation
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 ClassIndex = 0;
+};
+
+/**
+ * Point where merged corridors meet, a T-junction having three arms and a crossing four
+ */
+USTRUCT(BlueprintType)
+struct FDungeonCorridorJunction
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    FVector2D Location = FVector2D::ZeroVector;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 NumArms = 0;
+};
+
+/**
+ * Time and counts of each stage of one generation
+ * Stage times are in milliseconds, stages that did not run stay at zero
+ */
+USTRUCT(BlueprintType)
+struct FDungeonGenerationStats
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    double PlaceRoomsMs = 0.0;
+
+    // Separation solver, only used without physics separation
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    double SeparationMs = 0.0;
+
+    // Time until every simulated room was asleep, only used with physics separation
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    double PhysicsSettleMs = 0.0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    double OverlapRemovalMs = 0.0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    double TriangulationMs = 0.0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    double MSTMs = 0.0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    double CorridorLinesMs = 0.0;
+
+    // Merging of the collinear corridor segments and junction detection, only used when corridors are merged
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    double CorridorMergeMs = 0.0;
+
+    // Removal of the rooms no corridor goes through
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    double RoomCullingMs = 0.0;
+
+    // Spawning of the room and corridor actors, summed over frames when time sliced
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    double SpawnMs = 0.0;
+
+    // Wall clock time until the layout was complete, including the physics simulation when used
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    double TotalMs = 0.0;
+
+    // Whether the physics rooms were connected because the safety timeout fired before they all slept
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    bool bSafetyTimeoutFired = false;
+
+    // Whether the physics rooms were connected because the settle criterion was met before they all slept
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    bool bSettledBeforeSleep = false;
+
+    // Whether the layout was read from the layout cache, only the surviving room and corridor counts are then known
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    bool bLoadedFromCache = false;
+
+    // Rooms placed before any removal
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 NumSpawnedRooms = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 NumOverlappedRooms = 0;
+
+    // Rooms no corridor goes through
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 NumDisconnectedRooms = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 NumSurvivingRooms = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 NumTriangles = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 NumMSTEdges = 0;
+
+    // Corridor segments before merging, the same as NumCorridors when corridors are not merged
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 NumCorridorLines = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 NumCorridors = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 NumCorridorJunctions = 0;
+};
+
+/**
+ * Result of the layout generation, plain data independent from any world
+ * Room i uses RoomTransforms[i] and the room class RoomClassIndices[i]
+ */
+USTRUCT(BlueprintType)
+struct FDungeonLayout
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 Seed = 0;
+
+    // Height of the dungeon plane
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    double Height = 0.0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    TArray<FTransform> RoomTransforms;
+
+    // Index in the room classes given to the generation
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    TArray<int32> RoomClassIndices;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    TArray<FDungeonCorridorSegment> Corridors;
+
+    // Number of segments of the path of each MST edge, the segments of a path being consecutive in Corridors
+    // Not replicated and emptied once the dungeon is edited live, corridors are then no longer grouped by edge
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    TArray<int32> CorridorPathSegments;
+
+    // Whether collinear corridor segments were merged, paths then share segments and CorridorPathSegments is empty
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    bool bMergedCorridors = false;
+
+    // T-junctions and crossings of the merged corridors, empty when corridors are not merged
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    TArray<FDungeonCorridorJunction> CorridorJunctions;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    FDungeonGenerationStats Stats;
+
+    // Intermediate results, kept for debug visualization
+    SDungeonMesh Mesh;
+    TArray<int32> MST;
+
+    int32 NumRooms() const { return RoomTransforms.Num(); }
+
+    void Reset()
+    {
+        RoomTransforms.Reset();
+        RoomClassIndices.Reset();
+        Corridors.Reset();
+        CorridorPathSegments.Reset();
+        bMergedCorridors = false;
+        CorridorJunctions.Reset();
+        Mesh.Reset();
+        MST.Reset();
+        Stats = FDungeonGenerationStats();
+    }
+};
+
+/**
+ * Summary of one generated layout
+ */
+USTRUCT(BlueprintType)
+struct FDungeonLayoutMetrics
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 Seed = 0;
+
+    // False if the parameters were invalid or the generation was cancelled
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    bool bSucceeded = false;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 NumRooms = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 NumCorridors = 0;
+
+    // Sum of the corridor segment lengths
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    double CorridorLength = 0.0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    double GenerationTimeMs = 0.0;
+};
+
+/**
+ * Summary of a batch of generated layouts
+ */
+USTRUCT(BlueprintType)
+struct FDungeonBatchSummary
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 NumLayouts = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 NumFailed = 0;
+
+    // Room counts over the successful layouts
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 MinRooms = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    int32 MaxRooms = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    double AverageRooms = 0.0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    double AverageCorridorLength = 0.0;
+
+    // Average time of one generation, on one worker
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    double AverageGenerationTimeMs = 0.0;
+
+    // Wall clock time of the whole batch
+    UPROPERTY(BlueprintReadOnly, Category = "Dungeon Generation")
+    double TotalTimeMs = 0.0;
+};
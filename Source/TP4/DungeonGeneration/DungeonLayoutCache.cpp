@@ -0,0 +1,280 @@
+#include "DungeonLayoutCache.h"
+#include "TP4.h"
+#include "DungeonStats.h"
+#include "CorridorMerging.h"
+#include "Hash/xxhash.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+
+DECLARE_CYCLE_STAT(TEXT("Layout Cache Load"), STAT_DungeonLayoutCacheLoad, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Layout Cache Save"), STAT_DungeonLayoutCacheSave, STATGROUP_Dungeon);
+
+namespace
+{
+    // Serialized size of the fixed parts of a file, used to reject truncated files before allocating
+    constexpr int64 HeaderSize = sizeof(uint32) * 2 + sizeof(uint64) + sizeof(int32) + sizeof(double) + sizeof(int32) * 3 + sizeof(uint8);
+    constexpr int64 RoomSize = sizeof(double) * 2 + sizeof(uint8) + sizeof(uint16);
+    constexpr int64 CorridorSize = sizeof(double) * 4 + sizeof(uint16);
+    constexpr int64 PathSize = sizeof(uint16);
+
+    template<typename ValueType>
+    void HashValue(FXxHash64Builder& Builder, const ValueType& Value)
+    {
+        Builder.Update(&Value, sizeof(Value));
+    }
+}
+
+/**
+ * Computes the cache key of a generation
+ * Covers the seed, the room class footprints, the room count, the dungeon position and bounds,
+ * the separation, corridor routing and corridor merging settings and the version of the generation algorithm
+ * Layouts separated by physics also depend on when the simulation is considered settled
+ * @param Params - Generation inputs
+ * @param PhysicsSettle - Settle settings when the rooms are separated by the physics simulation, null otherwise
+ * @return Key of the layout
+ */
+uint64 UDungeonLayoutCache::ComputeKey(const SDungeonLayoutParams& Params, const SDungeonSettleSettings* PhysicsSettle)
+{
+    FXxHash64Builder Builder;
+    HashValue(Builder, UDungeonLayoutGenerator::AlgorithmVersion);
+    HashValue(Builder, PhysicsSettle != nullptr);
+    if (PhysicsSettle)
+    {
+        HashValue(Builder, PhysicsSettle->Criterion);
+        HashValue(Builder, PhysicsSettle->MaxSpeed);
+        HashValue(Builder, PhysicsSettle->MaxOverlapDepth);
+    }
+    HashValue(Builder, Params.Seed);
+    HashValue(Builder, Params.NumCorridorClasses);
+    HashValue(Builder, Params.RoomCount);
+    HashValue(Builder, Params.Position.X);
+    HashValue(Builder, Params.Position.Y);
+    HashValue(Builder, Params.Position.Z);
+    HashValue(Builder, Params.Bounds.X);
+    HashValue(Builder, Params.Bounds.Y);
+    HashValue(Builder, Params.SeparationMaxIterations);
+    HashValue(Builder, Params.bRouteCorridors);
+    HashValue(Builder, Params.CorridorCellSize);
+    HashValue(Builder, Params.bMergeCorridors);
+    HashValue(Builder, Params.GeometryPrecision);
+
+    HashValue(Builder, Params.RoomFootprints.Num());
+    for (const SRoomFootprint& Footprint : Params.RoomFootprints)
+    {
+        HashValue(Builder, Footprint.Extent.X);
+        HashValue(Builder, Footprint.Extent.Y);
+        HashValue(Builder, Footprint.Offset.X);
+        HashValue(Builder, Footprint.Offset.Y);
+    }
+
+    return Builder.Finalize().Hash;
+}
+
+/**
+ * Loads a cached layout
+ * The file is memory mapped and read in place, falling back to a regular read when mapping is not supported
+ * @param Key - Key computed from the generation inputs
+ * @param OutLayout - Receives the layout, without triangulation nor MST, the junctions of merged corridors are found again
+ * @return bool - False if no valid layout is stored for the key
+ */
+bool UDungeonLayoutCache::Load(uint64 Key, FDungeonLayout& OutLayout)
+{
+    DUNGEON_SCOPE(STAT_DungeonLayoutCacheLoad);
+
+    const double StartTime = FPlatformTime::Seconds();
+    const FString Path = GetCachePath(Key);
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    if (!PlatformFile.FileExists(*Path))
+    {
+        return false;
+    }
+
+    OutLayout.Reset();
+    bool bLoaded = false;
+
+    FOpenMappedResult MappedFile = PlatformFile.OpenMappedEx(*Path);
+    if (MappedFile.HasValue())
+    {
+        TUniquePtr<IMappedFileHandle> Handle = MappedFile.StealValue();
+        TUniquePtr<IMappedFileRegion> Region(Handle->MapRegion());
+        if (Region)
+        {
+            FMemoryReaderView Reader(FMemoryView(Region->GetMappedPtr(), Region->GetMappedSize()));
+            bLoaded = Serialize(Reader, Key, OutLayout);
+        }
+    }
+    else
+    {
+        TArray<uint8> Bytes;
+        if (FFileHelper::LoadFileToArray(Bytes, *Path))
+        {
+            FMemoryReader Reader(Bytes);
+            bLoaded = Serialize(Reader, Key, OutLayout);
+        }
+    }
+
+    if (!bLoaded)
+    {
+        UE_LOG(LogDungeon, Warning, TEXT("Ignoring invalid cached dungeon layout %s"), *Path);
+        OutLayout.Reset();
+        return false;
+    }
+
+    if (OutLayout.bMergedCorridors)
+    {
+        UCorridorMerging::FindJunctions(OutLayout.Corridors, OutLayout.CorridorJunctions);
+    }
+
+    FDungeonGenerationStats& Stats = OutLayout.Stats;
+    Stats.bLoadedFromCache = true;
+    Stats.NumSurvivingRooms = OutLayout.NumRooms();
+    Stats.NumCorridors = OutLayout.Corridors.Num();
+    Stats.NumCorridorJunctions = OutLayout.CorridorJunctions.Num();
+    Stats.TotalMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+    return true;
+}
+
+/**
+ * Stores a layout in the cache
+ * The layout is written to a temporary file first, so readers never see a partial file
+ * @param Key - Key computed from the generation inputs
+ * @param Layout - Layout to store
+ * @return bool - Whether the file was written
+ */
+bool UDungeonLayoutCache::Save(uint64 Key, const FDungeonLayout& Layout)
+{
+    DUNGEON_SCOPE(STAT_DungeonLayoutCacheSave);
+
+    const FString Path = GetCachePath(Key);
+    const FString TempPath = Path + TEXT(".tmp");
+
+    {
+        TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TempPath));
+        if (!Writer)
+        {
+            UE_LOG(LogDungeon, Warning, TEXT("Failed to create cached dungeon layout %s"), *TempPath);
+            return false;
+        }
+
+        // Serialize only reads the layout when saving
+        if (!Serialize(*Writer, Key, const_cast<FDungeonLayout&>(Layout)) || !Writer->Close())
+        {
+            UE_LOG(LogDungeon, Warning, TEXT("Failed to write cached dungeon layout %s"), *TempPath);
+            Writer.Reset();
+            IFileManager::Get().Delete(*TempPath);
+            return false;
+        }
+    }
+
+    return IFileManager::Get().Move(*Path, *TempPath, true);
+}
+
+void UDungeonLayoutCache::Clear()
+{
+    IFileManager::Get().DeleteDirectory(*GetCacheDir(), false, true);
+}
+
+FString UDungeonLayoutCache::GetCacheDir()
+{
+    return FPaths::ProjectSavedDir() / TEXT("DungeonCache");
+}
+
+FString UDungeonLayoutCache::GetCachePath(uint64 Key)
+{
+    return GetCacheDir() / FString::Printf(TEXT("%016llx.dlc"), Key);
+}
+
+/**
+ * Reads or writes a cache file
+ * Header: magic, format version, key, seed, height, room count, corridor count, corridor path count and whether corridors are merged
+ * Rooms: location, quarter turns and class index
+ * Corridors: start, end and class index
+ * Corridor paths: segment count
+ * @param Ar - Archive to serialize with
+ * @param Key - Key the file belongs to
+ * @param Layout - Layout to write, or receiving the layout read
+ * @return bool - False if the file is not a valid layout for the key or the archive failed
+ */
+bool UDungeonLayoutCache::Serialize(FArchive& Ar, uint64 Key, FDungeonLayout& Layout)
+{
+    uint32 FileMagic = Magic;
+    uint32 FileVersion = FormatVersion;
+    uint64 FileKey = Key;
+    int32 NumRooms = Layout.NumRooms();
+    int32 NumCorridors = Layout.Corridors.Num();
+    int32 NumPaths = Layout.CorridorPathSegments.Num();
+    uint8 bMergedCorridors = Layout.bMergedCorridors ? 1 : 0;
+
+    Ar << FileMagic << FileVersion << FileKey << Layout.Seed << Layout.Height << NumRooms << NumCorridors << NumPaths << bMergedCorridors;
+
+    if (Ar.IsLoading())
+    {
+        if (Ar.IsError() || FileMagic != Magic || FileVersion != FormatVersion || FileKey != Key || NumRooms < 0 || NumCorridors < 0 || NumPaths < 0
+            || Ar.TotalSize() != HeaderSize + NumRooms * RoomSize + NumCorridors * CorridorSize + NumPaths * PathSize)
+        {
+            return false;
+        }
+
+        Layout.RoomTransforms.SetNum(NumRooms);
+        Layout.RoomClassIndices.SetNum(NumRooms);
+        Layout.Corridors.SetNum(NumCorridors);
+        Layout.CorridorPathSegments.SetNum(NumPaths);
+        Layout.bMergedCorridors = bMergedCorridors != 0;
+    }
+
+    for (int32 i = 0; i < NumRooms; i++)
+    {
+        // Rooms only ever rotate by quarter turns around Z
+        FVector Location = Layout.RoomTransforms[i].GetLocation();
+        uint8 QuarterTurns = static_cast<uint8>((FMath::RoundToInt(Layout.RoomTransforms[i].Rotator().Yaw / 90.0) % 4 + 4) % 4);
+        uint16 ClassIndex = static_cast<uint16>(Layout.RoomClassIndices[i]);
+
+        Ar << Location.X << Location.Y << QuarterTurns << ClassIndex;
+
+        if (Ar.IsLoading())
+        {
+            Layout.RoomTransforms[i] = FTransform(FRotator(0.f, QuarterTurns * 90.f, 0.f), FVector(Location.X, Location.Y, Layout.Height));
+            Layout.RoomClassIndices[i] = ClassIndex;
+        }
+    }
+
+    for (FDungeonCorridorSegment& Segment : Layout.Corridors)
+    {
+        uint16 ClassIndex = static_cast<uint16>(Segment.ClassIndex);
+
+        Ar << Segment.Start.X << Segment.Start.Y << Segment.End.X << Segment.End.Y << ClassIndex;
+
+        if (Ar.IsLoading())
+        {
+            Segment.ClassIndex = ClassIndex;
+        }
+    }
+
+    int32 NumPathCorridors = 0;
+    for (int32& NumSegments : Layout.CorridorPathSegments)
+    {
+        uint16 PathSegments = static_cast<uint16>(NumSegments);
+
+        Ar << PathSegments;
+
+        if (Ar.IsLoading())
+        {
+            NumSegments = PathSegments;
+        }
+        NumPathCorridors += PathSegments;
+    }
+
+    // Paths must cover the corridors exactly, or not be stored at all
+    if (Ar.IsLoading() && NumPaths > 0 && NumPathCorridors != NumCorridors)
+    {
+        return false;
+    }
+
+    return !Ar.IsError();
+}
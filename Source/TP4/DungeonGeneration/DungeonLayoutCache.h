@@ -0,0 +1,59 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "DungeonLayout.h"
+#include "DungeonLayoutGenerator.h"
+#include "DungeonLayoutCache.generated.h"
+
+/**
+ * Settings of the physics separation a layout settled by physics depends on
+ */
+struct SDungeonSettleSettings
+{
+public:
+    // EDungeonSettleCriterion of the subsystem
+    uint8 Criterion = 0;
+    float MaxSpeed = 0.f;
+    float MaxOverlapDepth = 0.f;
+};
+
+/**
+ * Stores generated layouts on disk, keyed by the parameters they were generated from
+ * Files live in Saved/DungeonCache and are read back memory mapped
+ * Only the rooms and corridors are stored, the triangulation and MST of a cached layout are empty
+ */
+UCLASS()
+class TP4_API UDungeonLayoutCache : public UObject
+{
+    GENERATED_BODY()
+
+public:
+
+    // Hashes every input the layout depends on, PhysicsSettle is null for layouts separated on data
+    static uint64 ComputeKey(const SDungeonLayoutParams& Params, const SDungeonSettleSettings* PhysicsSettle);
+
+    // Reads the layout stored for a key, false if there is none or the file is invalid
+    static bool Load(uint64 Key, FDungeonLayout& OutLayout);
+
+    // Writes a layout for a key, replacing the previous one
+    static bool Save(uint64 Key, const FDungeonLayout& Layout);
+
+    // Deletes every cached layout
+    static void Clear();
+
+    static FString GetCacheDir();
+
+    static FString GetCachePath(uint64 Key);
+
+private:
+
+    // Serializes a layout in both directions, the header is validated when loading
+    static bool Serialize(FArchive& Ar, uint64 Key, FDungeonLayout& Layout);
+
+    // Identifies cache files, "DLYC"
+    static constexpr uint32 Magic = 0x43594C44;
+
+    // Bump when the file format changes
+    static constexpr uint32 FormatVersion = 3;
+};
@@ -0,0 +1,527 @@
+#include "DungeonLayoutGenerator.h"
+#include "Triangulation.h"
+#include "MinSpanTree.h"
+#include "RoomSeparation.h"
+#include "CorridorRouter.h"
+#include "CorridorMerging.h"
+#include "DungeonStats.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Generate Layout"), STAT_DungeonGenerateLayout, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Generate Layout Batch"), STAT_DungeonGenerateLayouts, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Place Rooms"), STAT_DungeonPlaceRooms, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Connect Rooms"), STAT_DungeonConnectRooms, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Corridor Lines"), STAT_DungeonCorridorLines, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Room Culling"), STAT_DungeonRoomCulling, STATGROUP_Dungeon);
+
+/**
+ * Generates a complete dungeon layout without touching any world
+ * The same parameters always produce the same layout
+ * @param Params - Generation inputs
+ * @param OutLayout - Receives the rooms and corridors of the dungeon
+ * @return bool - False if the parameters are invalid or the generation was cancelled
+ */
+bool UDungeonLayoutGenerator::GenerateLayout(const SDungeonLayoutParams& Params, FDungeonLayout& OutLayout)
+{
+    return GenerateLayout(Params, Params.Seed, OutLayout);
+}
+
+/**
+ * Generates a layout from a seed, ignoring the seed of the parameters
+ * Placement and separation data only live until the layout is written, on the memory stack of the calling thread
+ * @param Params - Generation inputs
+ * @param Seed - Seed of the random stream
+ * @param OutLayout - Receives the rooms and corridors of the dungeon, its arrays are reused
+ * @return bool - False if the parameters are invalid or the generation was cancelled
+ */
+bool UDungeonLayoutGenerator::GenerateLayout(const SDungeonLayoutParams& Params, int32 Seed, FDungeonLayout& OutLayout)
+{
+    DUNGEON_SCOPE(STAT_DungeonGenerateLayout);
+
+    const double StartTime = FPlatformTime::Seconds();
+
+    OutLayout.Reset();
+
+    // Set before any early return, so failed and cancelled layouts still report their seed
+    OutLayout.Seed = Seed;
+
+    // Validate input
+    if (Params.RoomFootprints.IsEmpty() || Params.NumCorridorClasses <= 0 || Params.RoomCount <= 0
+        || Params.Bounds.X < 0 || Params.Bounds.Y < 0)
+    {
+        return false;
+    }
+
+    FMemMark Mark(FMemStack::Get());
+
+    FRandomStream Stream(Seed);
+
+    double PlaceRoomsMs = 0.0;
+    double SeparationMs = 0.0;
+
+    TDungeonScratchArray<int32> ClassIndices;
+    TDungeonScratchArray<SRoomFootprint> Footprints;
+    ClassIndices.SetNumUninitialized(Params.RoomCount);
+    Footprints.SetNumUninitialized(Params.RoomCount);
+    {
+        SDungeonScopedTimer Timer(PlaceRoomsMs);
+        PlaceRooms(Params, Stream, ClassIndices, Footprints);
+    }
+
+    {
+        SDungeonScopedTimer Timer(SeparationMs);
+        URoomSeparation::SeparateRooms(Footprints, Params.SeparationMaxIterations);
+    }
+
+    if (Params.IsCancelled())
+    {
+        return false;
+    }
+
+    TDungeonScratchArray<int32> KeptRooms;
+    const bool bSucceeded = ConnectRooms(Params, Stream, ClassIndices, Footprints, OutLayout, KeptRooms);
+
+    OutLayout.Stats.PlaceRoomsMs = PlaceRoomsMs;
+    OutLayout.Stats.SeparationMs = SeparationMs;
+    OutLayout.Stats.TotalMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+    return bSucceeded;
+}
+
+/**
+ * Generates many layouts at once, one generation per worker
+ * Each generation draws from its own random stream, so the result of a seed does not depend on the batch
+ * Layouts already in OutLayouts are regenerated in place, so a batch run again reuses their arrays
+ * @param Params - Generation inputs shared by every layout
+ * @param Seeds - Seed of each layout
+ * @param OutLayouts - Receives one layout per seed
+ * @param OutMetrics - Receives the metrics of each layout
+ * @param bKeepDebugData - Whether to keep the triangulation and MST of each layout
+ * @return Summary of the batch
+ */
+FDungeonBatchSummary UDungeonLayoutGenerator::GenerateLayouts(const SDungeonLayoutParams& Params, const TArray<int32>& Seeds, TArray<FDungeonLayout>& OutLayouts, TArray<FDungeonLayoutMetrics>& OutMetrics, bool bKeepDebugData)
+{
+    DUNGEON_SCOPE(STAT_DungeonGenerateLayouts);
+
+    const double StartTime = FPlatformTime::Seconds();
+
+    OutLayouts.SetNum(Seeds.Num());
+    OutMetrics.Reset(Seeds.Num());
+    OutMetrics.SetNum(Seeds.Num());
+
+    ParallelFor(Seeds.Num(), [&](int32 Index)
+    {
+        const double LayoutStartTime = FPlatformTime::Seconds();
+
+        FDungeonLayout& Layout = OutLayouts[Index];
+        const bool bSucceeded = GenerateLayout(Params, Seeds[Index], Layout);
+        check(!bSucceeded || Layout.Seed == Seeds[Index]);
+
+        if (!bKeepDebugData)
+        {
+            Layout.Mesh.Reset();
+            Layout.MST.Reset();
+        }
+
+        FDungeonLayoutMetrics& Metrics = OutMetrics[Index];
+        Metrics = ComputeMetrics(Layout);
+        Metrics.bSucceeded = bSucceeded;
+        Metrics.GenerationTimeMs = (FPlatformTime::Seconds() - LayoutStartTime) * 1000.0;
+    });
+
+    // Summarize the successful layouts
+    FDungeonBatchSummary Summary;
+    Summary.NumLayouts = Seeds.Num();
+    Summary.MinRooms = MAX_int32;
+
+    for (const FDungeonLayoutMetrics& Metrics : OutMetrics)
+    {
+        if (!Metrics.bSucceeded)
+        {
+            Summary.NumFailed++;
+            continue;
+        }
+
+        Summary.MinRooms = FMath::Min(Summary.MinRooms, Metrics.NumRooms);
+        Summary.MaxRooms = FMath::Max(Summary.MaxRooms, Metrics.NumRooms);
+        Summary.AverageRooms += Metrics.NumRooms;
+        Summary.AverageCorridorLength += Metrics.CorridorLength;
+        Summary.AverageGenerationTimeMs += Metrics.GenerationTimeMs;
+    }
+
+    const int32 NumSucceeded = Summary.NumLayouts - Summary.NumFailed;
+    if (NumSucceeded > 0)
+    {
+        Summary.AverageRooms /= NumSucceeded;
+        Summary.AverageCorridorLength /= NumSucceeded;
+        Summary.AverageGenerationTimeMs /= NumSucceeded;
+    }
+    else
+    {
+        Summary.MinRooms = 0;
+    }
+
+    Summary.TotalTimeMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+    return Summary;
+}
+
+/**
+ * Counts the rooms and corridors of a layout
+ * @param Layout - Generated layout
+ * @return Metrics of the layout, without timing
+ */
+FDungeonLayoutMetrics UDungeonLayoutGenerator::ComputeMetrics(const FDungeonLayout& Layout)
+{
+    FDungeonLayoutMetrics Metrics;
+    Metrics.Seed = Layout.Seed;
+    Metrics.bSucceeded = true;
+    Metrics.NumRooms = Layout.NumRooms();
+    Metrics.NumCorridors = Layout.Corridors.Num();
+
+    for (const FDungeonCorridorSegment& Segment : Layout.Corridors)
+    {
+        Metrics.CorridorLength += FVector2D::Distance(Segment.Start, Segment.End);
+    }
+
+    return Metrics;
+}
+
+/**
+ * Creates initial room placements
+ * Rooms are given random classes, positions and orientations within bounds
+ * @param Params - Generation inputs
+ * @param Stream - Random stream of the generation
+ * @param OutClassIndices - Receives the room class of each room, sized by the caller
+ * @param OutFootprints - Receives the footprint of each room, sized by the caller
+ */
+void UDungeonLayoutGenerator::PlaceRooms(const SDungeonLayoutParams& Params, FRandomStream& Stream, TArrayView<int32> OutClassIndices, TArrayView<SRoomFootprint> OutFootprints)
+{
+    DUNGEON_SCOPE(STAT_DungeonPlaceRooms);
+
+    check(OutClassIndices.Num() == Params.RoomCount && OutFootprints.Num() == Params.RoomCount);
+
+    // Define possible room rotations (0, 90, 180, 270 degrees)
+    static const float PossibleAngles[] = { 0.f, 90.f, 180.f, 270.f };
+
+    const int32 NumClasses = Params.RoomFootprints.Num();
+
+    // Visit the room classes in a random order
+    FMemMark Mark(FMemStack::Get());
+
+    TDungeonScratchArray<int32> ShuffledClasses;
+    ShuffledClasses.Reserve(NumClasses);
+    for (int32 i = 0; i < NumClasses; i++)
+    {
+        ShuffledClasses.Add(i);
+    }
+    Shuffle(ShuffledClasses, Stream);
+
+    int32 NumRooms = 0;
+    auto AddRoom = [&](int32 ClassIndex)
+    {
+        // Randomly rotate the room and place it at random position within bounds
+        SRoomFootprint Footprint = Params.RoomFootprints[ClassIndex];
+        Footprint.Yaw = PossibleAngles[Stream.RandRange(0, static_cast<int32>(UE_ARRAY_COUNT(PossibleAngles)) - 1)];
+        Footprint.Location.X = Params.Position.X + Stream.FRandRange(-Params.Bounds.X, Params.Bounds.X);
+        Footprint.Location.Y = Params.Position.Y + Stream.FRandRange(-Params.Bounds.Y, Params.Bounds.Y);
+
+        OutClassIndices[NumRooms] = ClassIndex;
+        OutFootprints[NumRooms] = Footprint;
+        NumRooms++;
+    };
+
+    // First pass: Ensure at least one of each room type is placed
+    for (int32 i = 0; i < FMath::Min(Params.RoomCount, NumClasses); i++)
+    {
+        AddRoom(ShuffledClasses[i]);
+    }
+
+    // Second pass: Fill remaining rooms with random types
+    for (int32 i = 0; i < Params.RoomCount - NumClasses; i++)
+    {
+        AddRoom(ShuffledClasses[Stream.RandRange(0, NumClasses - 1)]);
+    }
+}
+
+/**
+ * Connects placed rooms with corridors
+ * Handles the main dungeon generation steps:
+ * 1. Removes overlapping rooms
+ * 2. Gets key points for triangulation
+ * 3. Creates Delaunay triangulation
+ * 4. Generates minimum spanning tree
+ * 5. Creates corridor layout
+ * 6. Keeps the rooms crossed by corridors
+ * The time and counts of each step are written to the stats of the layout
+ * @param Params - Generation inputs
+ * @param Stream - Random stream of the generation
+ * @param ClassIndices - Room class of each room
+ * @param Footprints - Final footprint of each room
+ * @param OutLayout - Receives the rooms and corridors of the dungeon, its seed is left to the caller
+ * @param OutKeptRooms - Receives the indices of the rooms present in the layout, in layout order
+ * @return bool - False if the generation was cancelled, the layout is then incomplete
+ */
+bool UDungeonLayoutGenerator::ConnectRooms(const SDungeonLayoutParams& Params, FRandomStream& Stream, TConstArrayView<int32> ClassIndices, TConstArrayView<SRoomFootprint> Footprints, FDungeonLayout& OutLayout, TDungeonScratchArray<int32>& OutKeptRooms)
+{
+    DUNGEON_SCOPE(STAT_DungeonConnectRooms);
+
+    OutLayout.Reset();
+    OutLayout.Height = Params.Position.Z;
+
+    // Sized before the mark, the kept rooms outlive the temporaries below
+    OutKeptRooms.Reset(Footprints.Num());
+
+    FMemMark Mark(FMemStack::Get());
+
+    FDungeonGenerationStats& Stats = OutLayout.Stats;
+    Stats.NumSpawnedRooms = Footprints.Num();
+
+    // Clean up rooms that ended up overlapping
+    TBitArray<TMemStackAllocator<>> Overlapped;
+    {
+        SDungeonScopedTimer Timer(Stats.OverlapRemovalMs);
+        URoomSeparation::FindOverlappedRooms(Footprints, Overlapped);
+    }
+
+    if (Params.IsCancelled())
+    {
+        return false;
+    }
+
+    TDungeonScratchArray<int32> Rooms;
+    Rooms.Reserve(Footprints.Num());
+    for (int32 i = 0; i < Footprints.Num(); i++)
+    {
+        if (!Overlapped[i])
+        {
+            Rooms.Add(i);
+        }
+    }
+
+    Stats.NumOverlappedRooms = Footprints.Num() - Rooms.Num();
+
+    TDungeonScratchArray<int32> PointRooms;
+    {
+        SDungeonScopedTimer Timer(Stats.TriangulationMs);
+
+        // Get key points for triangulation from room positions
+        TDungeonScratchArray<FVector2D> Points;
+        GetPoints(Footprints, Rooms, Stream, Points, PointRooms);
+
+        // Generate Delaunay triangulation
+        UTriangulation::GenerateMesh(Points, OutLayout.Mesh, Params.GeometryPrecision);
+    }
+
+    Stats.NumTriangles = OutLayout.Mesh.NumTriangles();
+
+    if (Params.IsCancelled())
+    {
+        return false;
+    }
+
+    // Create minimum spanning tree from triangulation
+    {
+        SDungeonScopedTimer Timer(Stats.MSTMs);
+        UMinSpanTree::GenerateMST(OutLayout.Mesh, OutLayout.MST, EMSTAlgorithm::Kruskal, Params.GeometryPrecision);
+    }
+
+    Stats.NumMSTEdges = OutLayout.MST.Num();
+
+    if (Params.IsCancelled())
+    {
+        return false;
+    }
+
+    // Generate routed or L-shaped corridor paths
+    TDungeonScratchArray<TPair<FVector2D, FVector2D>> CorridorLines;
+    {
+        DUNGEON_TIMED_SCOPE(STAT_DungeonCorridorLines, Stats.CorridorLinesMs);
+        if (Params.bRouteCorridors)
+        {
+            RouteCorridorLines(OutLayout.Mesh, OutLayout.MST, Footprints, Rooms, PointRooms, Params.CorridorCellSize, CorridorLines, OutLayout.CorridorPathSegments);
+        }
+        else
+        {
+            GenerateCorridorLines(OutLayout.Mesh, OutLayout.MST, Stream, CorridorLines);
+            OutLayout.CorridorPathSegments.Init(2, OutLayout.MST.Num());
+        }
+    }
+
+    // Keep only the rooms connected by corridors
+    {
+        DUNGEON_TIMED_SCOPE(STAT_DungeonRoomCulling, Stats.RoomCullingMs);
+
+        TBitArray<TMemStackAllocator<>> RoomsToKeep;
+        FindRoomsOnCorridorLines(Footprints, Rooms, CorridorLines, RoomsToKeep);
+
+        OutLayout.RoomTransforms.Reserve(Rooms.Num());
+        OutLayout.RoomClassIndices.Reserve(Rooms.Num());
+
+        for (int32 i = 0; i < Rooms.Num(); i++)
+        {
+            if (!RoomsToKeep[i])
+            {
+                continue;
+            }
+
+            const SRoomFootprint& Footprint = Footprints[Rooms[i]];
+            OutKeptRooms.Add(Rooms[i]);
+            OutLayout.RoomTransforms.Add(FTransform(FRotator(0.f, Footprint.Yaw, 0.f), FVector(Footprint.Location, OutLayout.Height)));
+            OutLayout.RoomClassIndices.Add(ClassIndices[Rooms[i]]);
+        }
+    }
+
+    Stats.NumSurvivingRooms = OutLayout.NumRooms();
+    Stats.NumDisconnectedRooms = Rooms.Num() - Stats.NumSurvivingRooms;
+
+    // Randomly select the corridor class of each segment
+    OutLayout.Corridors.Reserve(CorridorLines.Num());
+    for (const TPair<FVector2D, FVector2D>& CorridorLine : CorridorLines)
+    {
+        FDungeonCorridorSegment& Segment = OutLayout.Corridors.AddDefaulted_GetRef();
+        Segment.Start = CorridorLine.Key;
+        Segment.End = CorridorLine.Value;
+        Segment.ClassIndex = Stream.RandRange(0, Params.NumCorridorClasses - 1);
+    }
+
+    Stats.NumCorridorLines = OutLayout.Corridors.Num();
+
+    // Merge the segments paths share, paths are then no longer told apart
+    if (Params.bMergeCorridors)
+    {
+        SDungeonScopedTimer Timer(Stats.CorridorMergeMs);
+
+        UCorridorMerging::MergeCorridors(OutLayout.Corridors);
+        UCorridorMerging::FindJunctions(OutLayout.Corridors, OutLayout.CorridorJunctions);
+        OutLayout.CorridorPathSegments.Reset();
+        OutLayout.bMergedCorridors = true;
+    }
+
+    Stats.NumCorridors = OutLayout.Corridors.Num();
+    Stats.NumCorridorJunctions = OutLayout.CorridorJunctions.Num();
+
+    return true;
+}
+
+/**
+ * Selects key points for dungeon layout
+ * Takes a subset of room positions to use as nodes
+ * @param Rooms - Footprints of all rooms
+ * @param RoomIndices - Rooms to pick from
+ * @param Stream - Random stream of the generation
+ * @param OutPoints - Receives the 2D points for triangulation
+ * @param OutPointRooms - Receives the room of each point
+ */
+void UDungeonLayoutGenerator::GetPoints(TConstArrayView<SRoomFootprint> Rooms, TConstArrayView<int32> RoomIndices, FRandomStream& Stream, TDungeonScratchArray<FVector2D>& OutPoints, TDungeonScratchArray<int32>& OutPointRooms)
+{
+    // Select a subset of rooms (at least 4, up to 1/4 of total rooms)
+    int32 NumPointsToGet = FMath::Max(4, RoomIndices.Num() / 4);
+    NumPointsToGet = FMath::Min(NumPointsToGet, RoomIndices.Num());
+    OutPoints.Reset(NumPointsToGet);
+    OutPointRooms.Reset(NumPointsToGet);
+
+    FMemMark Mark(FMemStack::Get());
+
+    TDungeonScratchArray<int32> ShuffledRooms(RoomIndices);
+    Shuffle(ShuffledRooms, Stream);
+
+    // Get positions from selected rooms
+    for (int32 i = 0; i < NumPointsToGet; i++)
+    {
+        OutPoints.Add(Rooms[ShuffledRooms[i]].Location);
+        OutPointRooms.Add(ShuffledRooms[i]);
+    }
+}
+
+/**
+ * Generates L-shaped corridor paths between rooms
+ * Creates corridors by choosing random intermediate points
+ * @param Mesh - Triangulation the MST was built from
+ * @param MST - Minimum spanning tree mesh edge indices
+ * @param Stream - Random stream of the generation
+ * @param OutLines - Receives the corridor line segments
+ */
+void UDungeonLayoutGenerator::GenerateCorridorLines(const SDungeonMesh& Mesh, TConstArrayView<int32> MST, FRandomStream& Stream, TDungeonScratchArray<TPair<FVector2D, FVector2D>>& OutLines)
+{
+    OutLines.Reset(MST.Num() * 2);
+
+    // Create L-shaped paths for each MST edge
+    for (int32 EdgeIndex : MST)
+    {
+        AddCorridorLines(Mesh.GetEdgeStart(EdgeIndex), Mesh.GetEdgeEnd(EdgeIndex), Stream, OutLines);
+    }
+}
+
+/**
+ * Generates corridor paths going around the rooms
+ * Rooms are rasterized on a grid and each MST edge is routed with A*, in MST order
+ * Later paths follow the corridors routed before them where they can, so neighbouring edges share corridors
+ * The router is allocated on the stack of the caller, OutLines still growing while paths are routed
+ * @param Mesh - Triangulation the MST was built from
+ * @param MST - Minimum spanning tree mesh edge indices
+ * @param Rooms - Footprints of all rooms
+ * @param RoomIndices - Rooms corridors go around
+ * @param VertexRooms - Room of each mesh vertex, the paths of its edges cross it freely
+ * @param CellSize - Cell size of the routing grid
+ * @param OutLines - Receives the corridor line segments, the segments of each path being consecutive
+ * @param OutPathSegments - Receives the number of segments of each path, in MST order
+ */
+void UDungeonLayoutGenerator::RouteCorridorLines(const SDungeonMesh& Mesh, TConstArrayView<int32> MST, TConstArrayView<SRoomFootprint> Rooms, TConstArrayView<int32> RoomIndices, TConstArrayView<int32> VertexRooms, double CellSize, TDungeonScratchArray<TPair<FVector2D, FVector2D>>& OutLines, TArray<int32>& OutPathSegments)
+{
+    OutLines.Reset(MST.Num() * 3);
+    OutPathSegments.Reset(MST.Num());
+
+    SCorridorRouter Router;
+    Router.Build(Rooms, RoomIndices, CellSize);
+
+    for (int32 EdgeIndex : MST)
+    {
+        const FBox2D StartRoom = Rooms[VertexRooms[Mesh.GetEdgeStartIndex(EdgeIndex)]].GetBounds();
+        const FBox2D EndRoom = Rooms[VertexRooms[Mesh.GetEdgeEndIndex(EdgeIndex)]].GetBounds();
+        OutPathSegments.Add(Router.Route(Mesh.GetEdgeStart(EdgeIndex), StartRoom, Mesh.GetEdgeEnd(EdgeIndex), EndRoom, OutLines));
+    }
+}
+
+/**
+ * Finds the rooms crossed by corridors
+ * Tests each corridor segment once against the room footprints found in a uniform grid
+ * @param Rooms - Footprints of all rooms
+ * @param RoomIndices - Rooms to test
+ * @param CorridorLines - Corridor path segments
+ * @param OutRoomsToKeep - Receives one bit per entry of RoomIndices, set when a corridor goes through the room
+ */
+void UDungeonLayoutGenerator::FindRoomsOnCorridorLines(TConstArrayView<SRoomFootprint> Rooms, TConstArrayView<int32> RoomIndices, TConstArrayView<TPair<FVector2D, FVector2D>> CorridorLines, TBitArray<TMemStackAllocator<>>& OutRoomsToKeep)
+{
+    // Sized before the mark, the bits outlive the grid
+    OutRoomsToKeep.Init(false, RoomIndices.Num());
+
+    FMemMark Mark(FMemStack::Get());
+
+    // Index room footprints in a uniform grid
+    TDungeonScratchArray<FBox2D> Bounds;
+    Bounds.Reserve(RoomIndices.Num());
+    double CellSize = 0.0;
+
+    for (int32 RoomIndex : RoomIndices)
+    {
+        Bounds.Add(Rooms[RoomIndex].GetBounds());
+        CellSize = FMath::Max(CellSize, Bounds.Last().GetSize().GetMax());
+    }
+
+    SScratchRoomGrid Grid;
+    Grid.Build(Bounds, CellSize);
+
+    // Check each corridor line
+    for (const TPair<FVector2D, FVector2D>& Corridor : CorridorLines)
+    {
+        const FBox2D CorridorBounds(FVector2D::Min(Corridor.Key, Corridor.Value), FVector2D::Max(Corridor.Key, Corridor.Value));
+
+        Grid.ForEachInBox(CorridorBounds, [&](int32 GridIndex)
+        {
+            if (!OutRoomsToKeep[GridIndex] && Rooms[RoomIndices[GridIndex]].IntersectsSegment(Corridor.Key, Corridor.Value))
+            {
+                OutRoomsToKeep[GridIndex] = true;
+            }
+        });
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "DungeonLayout.h"
+#include "RoomGeometry.h"
+#include "DungeonScratch.h"
+#include "GeometryPolicy.h"
+#include <atomic>
+#include "DungeonLayoutGenerator.generated.h"
+
+/**
+ * Inputs of the layout generation
+ * Only plain data, so a layout can be generated without any world or actor
+ */
+struct SDungeonLayoutParams
+{
+public:
+    int32 Seed = 0;
+
+    // Footprint of each room class at the origin, indexed like the room classes
+    TArray<SRoomFootprint> RoomFootprints;
+
+    int32 NumCorridorClasses = 1;
+
+    // Total number of rooms to place
+    int32 RoomCount = 0;
+
+    // Center of the dungeon, Z being the height of the dungeon plane
+    FVector Position = FVector::ZeroVector;
+
+    // Half size of the area rooms are initially placed in
+    FVector2D Bounds = FVector2D::ZeroVector;
+
+    int32 SeparationMaxIterations = 1000;
+
+    // Route corridors around the rooms on a grid instead of joining rooms with random L-shapes
+    bool bRouteCorridors = false;
+
+    // Cell size of the corridor routing grid, roughly the width of a corridor
+    double CorridorCellSize = 100.0;
+
+    // Merge collinear corridor segments into the fewest segments and find their junctions
+    bool bMergeCorridors = false;
+
+    // Scalar type of the triangulation and MST, Fixed snaps the room centers to a grid and makes every predicate exact
+    EGeometryPrecision GeometryPrecision = EGeometryPrecision::Double;
+
+    // Set from another thread to stop the generation between two stages
+    const std::atomic<bool>* CancelFlag = nullptr;
+
+    bool IsCancelled() const { return CancelFlag && CancelFlag->load(std::memory_order_relaxed); }
+};
+
+UCLASS()
+class TP4_API UDungeonLayoutGenerator : public UObject
+{
+    GENERATED_BODY()
+
+public:
+
+    // Bump when the same parameters produce a different layout, cached layouts are then regenerated
+    static constexpr int32 AlgorithmVersion = 1;
+
+    // Runs every stage of the generation on data, from room placement to corridors, false if invalid or cancelled
+    static bool GenerateLayout(const SDungeonLayoutParams& Params, FDungeonLayout& OutLayout);
+
+    // Generates one layout per seed in parallel, the seed of Params is ignored
+    static FDungeonBatchSummary GenerateLayouts(const SDungeonLayoutParams& Params, const TArray<int32>& Seeds, TArray<FDungeonLayout>& OutLayouts, TArray<FDungeonLayoutMetrics>& OutMetrics, bool bKeepDebugData = false);
+
+    static FDungeonLayoutMetrics ComputeMetrics(const FDungeonLayout& Layout);
+
+    // Picks room classes, rotations and positions, rooms may overlap, both outputs hold Params.RoomCount entries
+    static void PlaceRooms(const SDungeonLayoutParams& Params, FRandomStream& Stream, TArrayView<int32> OutClassIndices, TArrayView<SRoomFootprint> OutFootprints);
+
+    // Connects placed rooms with corridors, OutKeptRooms receives the indices of the rooms present in the layout, false if cancelled
+    static bool ConnectRooms(const SDungeonLayoutParams& Params, FRandomStream& Stream, TConstArrayView<int32> ClassIndices, TConstArrayView<SRoomFootprint> Footprints, FDungeonLayout& OutLayout, TDungeonScratchArray<int32>& OutKeptRooms);
+
+    // Builds two axis aligned segments per MST edge
+    static void GenerateCorridorLines(const SDungeonMesh& Mesh, TConstArrayView<int32> MST, FRandomStream& Stream, TDungeonScratchArray<TPair<FVector2D, FVector2D>>& OutLines);
+
+    // Routes one path per MST edge around the rooms, OutPathSegments receives the number of segments of each path
+    static void RouteCorridorLines(const SDungeonMesh& Mesh, TConstArrayView<int32> MST, TConstArrayView<SRoomFootprint> Rooms, TConstArrayView<int32> RoomIndices, TConstArrayView<int32> VertexRooms, double CellSize, TDungeonScratchArray<TPair<FVector2D, FVector2D>>& OutLines, TArray<int32>& OutPathSegments);
+
+    // Appends the two axis aligned segments of an L-shaped path, randomly going horizontal or vertical first
+    template<typename AllocatorType>
+    static void AddCorridorLines(const FVector2D& Start, const FVector2D& End, FRandomStream& Stream, TArray<TPair<FVector2D, FVector2D>, AllocatorType>& OutLines)
+    {
+        // Randomly choose whether to go horizontal or vertical first
+        FVector2D IntermediatePoint = Stream.FRand() < 0.5f ? FVector2D(End.X, Start.Y) :
+                                                             FVector2D(Start.X, End.Y);
+
+        // Add both segments of the L-shaped path
+        OutLines.Add(TPair<FVector2D, FVector2D>(Start, IntermediatePoint));
+        OutLines.Add(TPair<FVector2D, FVector2D>(IntermediatePoint, End));
+    }
+
+private:
+
+    // Generation of a layout from the seed given instead of the one of Params, so batches share the parameters
+    static bool GenerateLayout(const SDungeonLayoutParams& Params, int32 Seed, FDungeonLayout& OutLayout);
+
+    static void GetPoints(TConstArrayView<SRoomFootprint> Rooms, TConstArrayView<int32> RoomIndices, FRandomStream& Stream, TDungeonScratchArray<FVector2D>& OutPoints, TDungeonScratchArray<int32>& OutPointRooms);
+
+    static void FindRoomsOnCorridorLines(TConstArrayView<SRoomFootprint> Rooms, TConstArrayView<int32> RoomIndices, TConstArrayView<TPair<FVector2D, FVector2D>> CorridorLines, TBitArray<TMemStackAllocator<>>& OutRoomsToKeep);
+
+    // Fisher-Yates shuffle drawing from the generation stream
+    template<typename ElementType, typename AllocatorType>
+    static void Shuffle(TArray<ElementType, AllocatorType>& Array, FRandomStream& Stream)
+    {
+        for (int32 i = Array.Num() - 1; i > 0; --i)
+        {
+            Array.Swap(i, Stream.RandRange(0, i));
+        }
+    }
+};
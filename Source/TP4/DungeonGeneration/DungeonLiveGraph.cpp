@@ -0,0 +1,419 @@
+#include "DungeonLiveGraph.h"
+#include "DungeonStats.h"
+#include "MinSpanTree.h"
+#include "Algo/Reverse.h"
+
+DECLARE_CYCLE_STAT(TEXT("Live Graph Build"), STAT_DungeonLiveGraphBuild, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Live Graph Add Node"), STAT_DungeonLiveGraphAddNode, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Live Graph Remove Node"), STAT_DungeonLiveGraphRemoveNode, STATGROUP_Dungeon);
+
+/**
+ * Builds the graph of an existing dungeon
+ * The super-triangle is much larger than the area so nodes added later stay far from its vertices
+ * @param Points - Node positions
+ * @param TreeEdges - Current spanning tree as pairs of indices into Points, kept as is
+ * @param Area - Area new nodes can be added in
+ * @param OutNodes - Node of each point
+ */
+void SDungeonLiveGraph::Build(const TArray<FVector2D>& Points, const TArray<SNodeEdge>& TreeEdges, const FBox2D& Area, TArray<int32>& OutNodes)
+{
+    DUNGEON_SCOPE(STAT_DungeonLiveGraphBuild);
+
+    Reset();
+
+    const FVector2D Center = Area.GetCenter();
+    const double Radius = FMath::Max(Area.GetExtent().GetMax(), 1.0) * 20.0;
+    Mesh.Initialize(Center + FVector2D(0.0, 2.0 * Radius),
+                    Center + FVector2D(-UE_DOUBLE_SQRT_3 * Radius, -Radius),
+                    Center + FVector2D(UE_DOUBLE_SQRT_3 * Radius, -Radius));
+
+    OutNodes.Reset(Points.Num());
+    for (const FVector2D& Point : Points)
+    {
+        OutNodes.Add(Mesh.IsInside(Point) ? Mesh.InsertVertex(Point) : INDEX_NONE);
+    }
+
+    TreeNeighbors.SetNum(Mesh.Vertices.Num());
+    AliveNodes.Init(false, Mesh.Vertices.Num());
+    for (int32 Node : OutNodes)
+    {
+        if (Node != INDEX_NONE && !AliveNodes[Node])
+        {
+            AliveNodes[Node] = true;
+            NumAliveNodes++;
+        }
+    }
+
+    for (const SNodeEdge& Edge : TreeEdges)
+    {
+        const int32 A = OutNodes[Edge.A];
+        const int32 B = OutNodes[Edge.B];
+        if (A != INDEX_NONE && B != INDEX_NONE && A != B && !TreeNeighbors[A].Contains(B))
+        {
+            AddTreeEdge(SNodeEdge(A, B));
+        }
+    }
+}
+
+void SDungeonLiveGraph::Reset()
+{
+    Mesh.Vertices.Reset();
+    Mesh.Triangles.Reset();
+    TreeNeighbors.Reset();
+    AliveNodes.Reset();
+    NumAliveNodes = 0;
+    SearchStamps.Reset();
+    SearchParents.Reset();
+    SearchSides.Reset();
+    SearchStamp = 0;
+}
+
+/**
+ * Inserts a node in the triangulation, then offers the tree each new Delaunay edge of the node, shortest first
+ * Adding an edge closes a cycle, the longest edge of that cycle is dropped (cycle property)
+ * The new tree is a subset of the old tree plus the edges of the new node, so no other edge has to be looked at
+ * @param Point - Position of the node
+ * @param OutAddedEdges - Tree edges created by the insertion
+ * @param OutRemovedEdges - Tree edges removed by the insertion
+ * @return The new node, INDEX_NONE if it could not be added
+ */
+int32 SDungeonLiveGraph::AddNode(const FVector2D& Point, TArray<SNodeEdge>& OutAddedEdges, TArray<SNodeEdge>& OutRemovedEdges)
+{
+    DUNGEON_SCOPE(STAT_DungeonLiveGraphAddNode);
+
+    if (!IsBuilt() || !Mesh.IsInside(Point))
+    {
+        return INDEX_NONE;
+    }
+
+    // An existing vertex is returned for duplicated points, removed nodes are no longer part of the mesh
+    const int32 NumVertices = Mesh.Vertices.Num();
+    const int32 Node = Mesh.InsertVertex(Point);
+    if (Node < NumVertices)
+    {
+        return INDEX_NONE;
+    }
+
+    TreeNeighbors.SetNum(Mesh.Vertices.Num());
+    AliveNodes.Add(true);
+    NumAliveNodes++;
+
+    TArray<int32> Neighbors;
+    Mesh.GetVertexNeighbors(Node, Neighbors);
+
+    TArray<SNodeEdge> Candidates;
+    for (int32 Neighbor : Neighbors)
+    {
+        if (!Mesh.IsSuperVertex(Neighbor))
+        {
+            Candidates.Add(SNodeEdge(Node, Neighbor));
+        }
+    }
+
+    Candidates.Sort([this](const SNodeEdge& Lhs, const SNodeEdge& Rhs)
+    {
+        return IsShorter(Lhs, Rhs);
+    });
+
+    TArray<int32> Path;
+    for (const SNodeEdge& Candidate : Candidates)
+    {
+        const int32 Neighbor = Candidate.A == Node ? Candidate.B : Candidate.A;
+
+        if (TreeNeighbors[Node].Num() > 0 && FindTreePath(Neighbor, Node, Path))
+        {
+            SNodeEdge Longest(Path[0], Path[1]);
+            for (int32 i = 2; i < Path.Num(); i++)
+            {
+                const SNodeEdge Edge(Path[i - 1], Path[i]);
+                if (IsShorter(Longest, Edge))
+                {
+                    Longest = Edge;
+                }
+            }
+
+            if (!IsShorter(Candidate, Longest))
+            {
+                continue;
+            }
+
+            RemoveTreeEdge(Longest);
+            if (OutAddedEdges.Remove(Longest) == 0)
+            {
+                OutRemovedEdges.Add(Longest);
+            }
+        }
+
+        AddTreeEdge(Candidate);
+        OutAddedEdges.Add(Candidate);
+    }
+
+    return Node;
+}
+
+/**
+ * Removes a node from the triangulation, which splits the tree into one part per tree edge of the node
+ * The parts are joined again with the shortest Delaunay edges between them, which can be anywhere along their border
+ * Parts are labelled by flooding them in lockstep until only the largest is left unfinished, every edge joining two parts
+ * then has an end in a finished part, so the cost depends on the size of the parts cut off rather than on the whole tree
+ * @param Node - Node to remove
+ * @param OutAddedEdges - Tree edges created by the removal
+ * @param OutRemovedEdges - Tree edges removed by the removal
+ */
+void SDungeonLiveGraph::RemoveNode(int32 Node, TArray<SNodeEdge>& OutAddedEdges, TArray<SNodeEdge>& OutRemovedEdges)
+{
+    DUNGEON_SCOPE(STAT_DungeonLiveGraphRemoveNode);
+
+    if (!IsNode(Node))
+    {
+        return;
+    }
+
+    const TArray<int32, TInlineAllocator<4>> PartRoots = TreeNeighbors[Node];
+    for (int32 Root : PartRoots)
+    {
+        const SNodeEdge Edge(Node, Root);
+        RemoveTreeEdge(Edge);
+        OutRemovedEdges.Add(Edge);
+    }
+
+    Mesh.RemoveVertex(Node);
+    AliveNodes[Node] = false;
+    NumAliveNodes--;
+
+    // A leaf leaves a single part behind
+    const int32 NumParts = PartRoots.Num();
+    if (NumParts < 2)
+    {
+        return;
+    }
+
+    PrepareSearch();
+
+    // Flood every part one node at a time, the queue of a part ends up holding all of its nodes
+    TArray<TArray<int32>> PartQueues;
+    TArray<int32> QueueHeads;
+    PartQueues.SetNum(NumParts);
+    QueueHeads.Init(0, NumParts);
+    for (int32 Part = 0; Part < NumParts; Part++)
+    {
+        SearchStamps[PartRoots[Part]] = SearchStamp;
+        SearchSides[PartRoots[Part]] = Part;
+        PartQueues[Part].Add(PartRoots[Part]);
+    }
+
+    int32 NumUnfinishedParts = NumParts;
+    while (NumUnfinishedParts > 1)
+    {
+        for (int32 Part = 0; Part < NumParts && NumUnfinishedParts > 1; Part++)
+        {
+            if (QueueHeads[Part] == PartQueues[Part].Num())
+            {
+                continue;
+            }
+
+            for (int32 Neighbor : TreeNeighbors[PartQueues[Part][QueueHeads[Part]++]])
+            {
+                if (SearchStamps[Neighbor] != SearchStamp)
+                {
+                    SearchStamps[Neighbor] = SearchStamp;
+                    SearchSides[Neighbor] = Part;
+                    PartQueues[Part].Add(Neighbor);
+                }
+            }
+
+            if (QueueHeads[Part] == PartQueues[Part].Num())
+            {
+                NumUnfinishedParts--;
+            }
+        }
+    }
+
+    // Nodes not reached yet belong to the unfinished part
+    int32 LargestPart = 0;
+    while (LargestPart < NumParts - 1 && QueueHeads[LargestPart] == PartQueues[LargestPart].Num())
+    {
+        LargestPart++;
+    }
+
+    auto GetPart = [this, LargestPart](int32 PartNode)
+    {
+        return SearchStamps[PartNode] == SearchStamp ? int32(SearchSides[PartNode]) : LargestPart;
+    };
+
+    // Delaunay edges leaving the finished parts
+    TArray<SNodeEdge> Candidates;
+    TArray<int32> Neighbors;
+    for (int32 Part = 0; Part < NumParts; Part++)
+    {
+        if (Part == LargestPart)
+        {
+            continue;
+        }
+
+        for (int32 PartNode : PartQueues[Part])
+        {
+            Neighbors.Reset();
+            Mesh.GetVertexNeighbors(PartNode, Neighbors);
+            for (int32 Neighbor : Neighbors)
+            {
+                if (Mesh.IsSuperVertex(Neighbor))
+                {
+                    continue;
+                }
+
+                const int32 NeighborPart = GetPart(Neighbor);
+
+                // Edges between two finished parts are seen from both ends, keep one
+                if (NeighborPart != Part && (NeighborPart == LargestPart || PartNode < Neighbor))
+                {
+                    Candidates.Add(SNodeEdge(PartNode, Neighbor));
+                }
+            }
+        }
+    }
+
+    Candidates.Sort([this](const SNodeEdge& Lhs, const SNodeEdge& Rhs)
+    {
+        return IsShorter(Lhs, Rhs);
+    });
+
+    // Kruskal on the parts
+    SDisjointSet Parts;
+    Parts.Initialize(NumParts);
+    int32 NumMissingEdges = NumParts - 1;
+    for (int32 i = 0; i < Candidates.Num() && NumMissingEdges > 0; i++)
+    {
+        const SNodeEdge& Candidate = Candidates[i];
+        if (Parts.Union(GetPart(Candidate.A), GetPart(Candidate.B)))
+        {
+            AddTreeEdge(Candidate);
+            OutAddedEdges.Add(Candidate);
+            NumMissingEdges--;
+        }
+    }
+}
+
+void SDungeonLiveGraph::GetTreeEdges(TArray<SNodeEdge>& OutEdges) const
+{
+    for (int32 Node = 0; Node < TreeNeighbors.Num(); Node++)
+    {
+        for (int32 Neighbor : TreeNeighbors[Node])
+        {
+            if (Node < Neighbor)
+            {
+                OutEdges.Add(SNodeEdge(Node, Neighbor));
+            }
+        }
+    }
+}
+
+bool SDungeonLiveGraph::IsShorter(const SNodeEdge& Lhs, const SNodeEdge& Rhs) const
+{
+    const double LhsLength = FVector2D::DistSquared(Mesh.Vertices[Lhs.A], Mesh.Vertices[Lhs.B]);
+    const double RhsLength = FVector2D::DistSquared(Mesh.Vertices[Rhs.A], Mesh.Vertices[Rhs.B]);
+    if (LhsLength != RhsLength)
+    {
+        return LhsLength < RhsLength;
+    }
+    return Lhs.A < Rhs.A || (Lhs.A == Rhs.A && Lhs.B < Rhs.B);
+}
+
+void SDungeonLiveGraph::AddTreeEdge(const SNodeEdge& Edge)
+{
+    TreeNeighbors[Edge.A].Add(Edge.B);
+    TreeNeighbors[Edge.B].Add(Edge.A);
+}
+
+void SDungeonLiveGraph::RemoveTreeEdge(const SNodeEdge& Edge)
+{
+    TreeNeighbors[Edge.A].RemoveSwap(Edge.B);
+    TreeNeighbors[Edge.B].RemoveSwap(Edge.A);
+}
+
+/**
+ * Bidirectional breadth-first search on the tree, always growing the smaller frontier
+ * @param From - First end of the path
+ * @param To - Last end of the path
+ * @param OutPath - Nodes of the path, From first
+ * @return Whether both nodes are connected
+ */
+bool SDungeonLiveGraph::FindTreePath(int32 From, int32 To, TArray<int32>& OutPath) const
+{
+    OutPath.Reset();
+    PrepareSearch();
+
+    const int32 Ends[2] = { From, To };
+    for (int32 Side = 0; Side < 2; Side++)
+    {
+        SearchStamps[Ends[Side]] = SearchStamp;
+        SearchParents[Ends[Side]] = INDEX_NONE;
+        SearchSides[Ends[Side]] = Side;
+        SearchFrontiers[Side].Reset();
+        SearchFrontiers[Side].Add(Ends[Side]);
+    }
+
+    if (From == To)
+    {
+        OutPath.Add(From);
+        return true;
+    }
+
+    while (SearchFrontiers[0].Num() > 0 && SearchFrontiers[1].Num() > 0)
+    {
+        const int32 Side = SearchFrontiers[0].Num() <= SearchFrontiers[1].Num() ? 0 : 1;
+        SearchNextFrontier.Reset();
+
+        for (int32 Current : SearchFrontiers[Side])
+        {
+            for (int32 Neighbor : TreeNeighbors[Current])
+            {
+                if (SearchStamps[Neighbor] != SearchStamp)
+                {
+                    SearchStamps[Neighbor] = SearchStamp;
+                    SearchParents[Neighbor] = Current;
+                    SearchSides[Neighbor] = Side;
+                    SearchNextFrontier.Add(Neighbor);
+                    continue;
+                }
+
+                if (SearchSides[Neighbor] == Side)
+                {
+                    continue;
+                }
+
+                // Both searches met, walk back to each end
+                const int32 FromSideNode = Side == 0 ? Current : Neighbor;
+                const int32 ToSideNode = Side == 0 ? Neighbor : Current;
+
+                for (int32 Node = FromSideNode; Node != INDEX_NONE; Node = SearchParents[Node])
+                {
+                    OutPath.Add(Node);
+                }
+                Algo::Reverse(OutPath);
+                for (int32 Node = ToSideNode; Node != INDEX_NONE; Node = SearchParents[Node])
+                {
+                    OutPath.Add(Node);
+                }
+                return true;
+            }
+        }
+
+        Swap(SearchFrontiers[Side], SearchNextFrontier);
+    }
+
+    return false;
+}
+
+void SDungeonLiveGraph::PrepareSearch() const
+{
+    const int32 NumVertices = Mesh.Vertices.Num();
+    if (SearchStamps.Num() < NumVertices)
+    {
+        SearchStamps.SetNumZeroed(NumVertices);
+        SearchParents.SetNum(NumVertices);
+        SearchSides.SetNum(NumVertices);
+    }
+
+    SearchStamp++;
+}
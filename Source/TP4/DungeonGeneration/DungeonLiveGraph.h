@@ -0,0 +1,94 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Triangulation.h"
+
+/**
+ * Edge of the live spanning tree between two nodes, stored with A < B
+ */
+struct SNodeEdge
+{
+public:
+    int32 A = INDEX_NONE;
+    int32 B = INDEX_NONE;
+
+    SNodeEdge() {}
+
+    SNodeEdge(int32 InA, int32 InB)
+        : A(FMath::Min(InA, InB))
+        , B(FMath::Max(InA, InB))
+    {
+    }
+
+    bool operator==(const SNodeEdge& Other) const
+    {
+        return A == Other.A && B == Other.B;
+    }
+
+    uint64 GetKey() const { return (uint64(uint32(A)) << 32) | uint32(B); }
+};
+
+/**
+ * Delaunay triangulation and minimum spanning tree of the dungeon nodes, kept up to date as nodes are added and removed
+ * Only the triangles around the changed node are retriangulated and the tree is repaired with local searches,
+ * so an edit costs about the same whatever the size of the dungeon
+ * Nodes are identified by their vertex index in the triangulation, which stays valid until the node is removed
+ */
+struct SDungeonLiveGraph
+{
+public:
+    // Triangulates the points and takes TreeEdges (pairs of point indices) as the spanning tree, OutNodes receives the node of each point
+    // Nodes can later be added anywhere inside Area, which should cover the dungeon with some room to grow
+    void Build(const TArray<FVector2D>& Points, const TArray<SNodeEdge>& TreeEdges, const FBox2D& Area, TArray<int32>& OutNodes);
+
+    void Reset();
+
+    bool IsBuilt() const { return Mesh.Vertices.Num() > 0; }
+
+    // Adds a node and reconnects the tree around it, INDEX_NONE if the point is outside the area or already a node
+    int32 AddNode(const FVector2D& Point, TArray<SNodeEdge>& OutAddedEdges, TArray<SNodeEdge>& OutRemovedEdges);
+
+    // Removes a node and reconnects the parts of the tree it was joining
+    void RemoveNode(int32 Node, TArray<SNodeEdge>& OutAddedEdges, TArray<SNodeEdge>& OutRemovedEdges);
+
+    bool IsNode(int32 Node) const { return AliveNodes.IsValidIndex(Node) && AliveNodes[Node]; }
+
+    const FVector2D& GetNodePosition(int32 Node) const { return Mesh.Vertices[Node]; }
+
+    int32 NumNodes() const { return NumAliveNodes; }
+
+    void GetTreeEdges(TArray<SNodeEdge>& OutEdges) const;
+
+private:
+    // Strict order on edges, by length then by nodes, so ties always resolve the same way
+    bool IsShorter(const SNodeEdge& Lhs, const SNodeEdge& Rhs) const;
+
+    void AddTreeEdge(const SNodeEdge& Edge);
+
+    void RemoveTreeEdge(const SNodeEdge& Edge);
+
+    // Finds the tree path between two nodes by searching from both ends at once, false if they are not connected
+    // Stops as soon as both searches meet, so the cost depends on the path and not on the size of the tree
+    bool FindTreePath(int32 From, int32 To, TArray<int32>& OutPath) const;
+
+    // Starts a new search, every vertex being unvisited
+    void PrepareSearch() const;
+
+    SDelaunayMesh Mesh;
+
+    // Tree neighbors of each vertex, super-triangle vertices and removed nodes have none
+    TArray<TArray<int32, TInlineAllocator<4>>> TreeNeighbors;
+
+    TArray<bool> AliveNodes;
+
+    int32 NumAliveNodes = 0;
+
+    // Search state, stamped so nothing has to be cleared between searches
+    // Sides are the end a path search came from, or the part a node belongs to when removing a node
+    mutable TArray<uint32> SearchStamps;
+    mutable TArray<int32> SearchParents;
+    mutable TArray<uint8> SearchSides;
+    mutable TArray<int32> SearchFrontiers[2];
+    mutable TArray<int32> SearchNextFrontier;
+    mutable uint32 SearchStamp = 0;
+};
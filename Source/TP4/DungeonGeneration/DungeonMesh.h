@@ -0,0 +1,43 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Compact indexed mesh shared by the triangulation, MST and corridor stages
+ * Triangles and edges are stored as indices into a single vertex buffer,
+ * vertex i being the i-th point given to the triangulation
+ */
+struct SDungeonMesh
+{
+public:
+    TArray<FVector2D> Vertices;
+
+    // Three vertex indices per triangle, counter-clockwise
+    TArray<int32> Triangles;
+
+    // Two vertex indices per unique edge
+    TArray<int32> Edges;
+
+    int32 NumTriangles() const { return Triangles.Num() / 3; }
+
+    int32 NumEdges() const { return Edges.Num() / 2; }
+
+    const FVector2D& GetTriangleVertex(int32 TriangleIndex, int32 Corner) const { return Vertices[Triangles[TriangleIndex * 3 + Corner]]; }
+
+    int32 GetEdgeStartIndex(int32 EdgeIndex) const { return Edges[EdgeIndex * 2]; }
+
+    int32 GetEdgeEndIndex(int32 EdgeIndex) const { return Edges[EdgeIndex * 2 + 1]; }
+
+    const FVector2D& GetEdgeStart(int32 EdgeIndex) const { return Vertices[GetEdgeStartIndex(EdgeIndex)]; }
+
+    const FVector2D& GetEdgeEnd(int32 EdgeIndex) const { return Vertices[GetEdgeEndIndex(EdgeIndex)]; }
+
+    double GetEdgeLengthSquared(int32 EdgeIndex) const { return FVector2D::DistSquared(GetEdgeStart(EdgeIndex), GetEdgeEnd(EdgeIndex)); }
+
+    void Reset()
+    {
+        Vertices.Reset();
+        Triangles.Reset();
+        Edges.Reset();
+    }
+};
@@ -0,0 +1,372 @@
+#include "DungeonReplicator.h"
+#include "TP4.h"
+#include "DungeonSubsystem.h"
+#include "CorridorMerging.h"
+#include "Engine/GameInstance.h"
+#include "EngineUtils.h"
+#include "Net/UnrealNetwork.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+bool FDungeonReplicatedChunk::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << Revision;
+	Ar << Index;
+	Ar << Bytes;
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+ADungeonLayoutChunk::ADungeonLayoutChunk()
+{
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	bReplicates = true;
+	bAlwaysRelevant = true;
+
+	// Chunks only change when a layout is published, updates are forced then
+	NetUpdateFrequency = 1.f;
+
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+void ADungeonLayoutChunk::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ADungeonLayoutChunk, Chunk);
+}
+
+void ADungeonLayoutChunk::OnRep_Owner()
+{
+	Super::OnRep_Owner();
+
+	NotifyReplicator();
+}
+
+void ADungeonLayoutChunk::OnRep_Chunk()
+{
+	NotifyReplicator();
+}
+
+void ADungeonLayoutChunk::NotifyReplicator()
+{
+	if (ADungeonReplicator* Replicator = Cast<ADungeonReplicator>(GetOwner()))
+	{
+		Replicator->TryApplyLayout();
+	}
+}
+
+ADungeonReplicator::ADungeonReplicator()
+{
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	bReplicates = true;
+	bAlwaysRelevant = true;
+
+	// The layout only changes when a dungeon is generated, updates are forced then
+	NetUpdateFrequency = 1.f;
+
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+void ADungeonReplicator::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ADungeonReplicator, RoomClasses);
+	DOREPLIFETIME(ADungeonReplicator, CorridorClasses);
+	DOREPLIFETIME(ADungeonReplicator, ReplicatedLayout);
+}
+
+void ADungeonReplicator::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (HasAuthority())
+	{
+		PublishChunks(TArray<uint8>());
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+/**
+ * Encodes a layout and marks it for replication
+ * @param Layout - Layout spawned by the server
+ * @param InRoomClasses - Room types the layout was generated with
+ * @param InCorridorClasses - Corridor types the layout was generated with
+ */
+void ADungeonReplicator::SetLayout(const FDungeonLayout& Layout, const TArray<TSubclassOf<ARoomBase>>& InRoomClasses, const TArray<TSubclassOf<ACorridorBase>>& InCorridorClasses)
+{
+	RoomClasses = InRoomClasses;
+	CorridorClasses = InCorridorClasses;
+
+	TArray<uint8> Blob;
+	EncodeLayout(Layout, Blob);
+
+	ReplicatedLayout.Revision++;
+	ReplicatedLayout.Seed = Layout.Seed;
+	PublishChunks(Blob);
+
+	ForceNetUpdate();
+
+	UE_LOG(LogDungeon, Log, TEXT("Replicating dungeon layout %d: %d rooms and %d corridors in %d bytes, %d chunks"),
+		ReplicatedLayout.Revision, Layout.NumRooms(), Layout.Corridors.Num(), Blob.Num(), ReplicatedLayout.NumChunks);
+}
+
+void ADungeonReplicator::ClearLayout()
+{
+	ReplicatedLayout.Revision++;
+	PublishChunks(TArray<uint8>());
+
+	ForceNetUpdate();
+}
+
+/**
+ * Splits a blob into chunk actors, each replicating on its own channel
+ * Chunk actors of the previous layout are reused, the extra ones destroyed
+ * @param Blob - Encoded layout, empty to clear the dungeon
+ */
+void ADungeonReplicator::PublishChunks(const TArray<uint8>& Blob)
+{
+	const int32 NumChunks = FMath::DivideAndRoundUp(Blob.Num(), ChunkSize);
+
+	while (Chunks.Num() > NumChunks)
+	{
+		if (IsValid(Chunks.Last()))
+		{
+			Chunks.Last()->Destroy();
+		}
+		Chunks.Pop(EAllowShrinking::No);
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Owner = this;
+	while (Chunks.Num() < NumChunks)
+	{
+		Chunks.Add(GetWorld()->SpawnActor<ADungeonLayoutChunk>(SpawnParameters));
+	}
+
+	for (int32 i = 0; i < NumChunks; i++)
+	{
+		ADungeonLayoutChunk* Chunk = Chunks[i];
+		if (!IsValid(Chunk))
+		{
+			UE_LOG(LogDungeon, Warning, TEXT("Failed to spawn chunk %d of dungeon layout %d, clients won't rebuild it"), i, ReplicatedLayout.Revision);
+			continue;
+		}
+
+		const int32 Offset = i * ChunkSize;
+		Chunk->Chunk.Revision = ReplicatedLayout.Revision;
+		Chunk->Chunk.Index = i;
+		Chunk->Chunk.Bytes.Reset();
+		Chunk->Chunk.Bytes.Append(Blob.GetData() + Offset, FMath::Min(ChunkSize, Blob.Num() - Offset));
+		Chunk->ForceNetUpdate();
+	}
+
+	ReplicatedLayout.NumChunks = NumChunks;
+	ReplicatedLayout.BlobSize = Blob.Num();
+}
+
+/**
+ * Writes a layout as variable length integers
+ * Positions are quantized to QuantizationStep relative to the lowest corner of the layout
+ * Rooms: position, class index and quarter turns
+ * Corridors: start, end and class index
+ * Junctions of merged corridors are not written, clients find them again
+ * @param Layout - Layout to encode
+ * @param OutBlob - Receives the encoded layout
+ */
+void ADungeonReplicator::EncodeLayout(const FDungeonLayout& Layout, TArray<uint8>& OutBlob)
+{
+	OutBlob.Reset();
+	FMemoryWriter Writer(OutBlob);
+
+	FVector2D Origin(DBL_MAX, DBL_MAX);
+	for (const FTransform& Transform : Layout.RoomTransforms)
+	{
+		Origin = FVector2D::Min(Origin, FVector2D(Transform.GetLocation()));
+	}
+	for (const FDungeonCorridorSegment& Segment : Layout.Corridors)
+	{
+		Origin = FVector2D::Min(Origin, FVector2D::Min(Segment.Start, Segment.End));
+	}
+
+	uint8 Version = BlobVersion;
+	double Height = Layout.Height;
+	uint8 bMergedCorridors = Layout.bMergedCorridors ? 1 : 0;
+	uint32 NumRooms = Layout.NumRooms();
+	uint32 NumCorridors = Layout.Corridors.Num();
+	Writer << Version << Height << Origin.X << Origin.Y << bMergedCorridors;
+	Writer.SerializeIntPacked(NumRooms);
+	Writer.SerializeIntPacked(NumCorridors);
+
+	auto WritePoint = [&Writer, &Origin](const FVector2D& Point)
+	{
+		uint32 X = static_cast<uint32>(FMath::RoundToInt64((Point.X - Origin.X) / QuantizationStep));
+		uint32 Y = static_cast<uint32>(FMath::RoundToInt64((Point.Y - Origin.Y) / QuantizationStep));
+		Writer.SerializeIntPacked(X);
+		Writer.SerializeIntPacked(Y);
+	};
+
+	for (int32 i = 0; i < Layout.NumRooms(); i++)
+	{
+		// Rooms only ever rotate by quarter turns around Z
+		const FTransform& Transform = Layout.RoomTransforms[i];
+		const uint32 QuarterTurns = (FMath::RoundToInt(Transform.Rotator().Yaw / 90.0) % 4 + 4) % 4;
+		uint32 ClassAndTurns = (static_cast<uint32>(Layout.RoomClassIndices[i]) << 2) | QuarterTurns;
+
+		WritePoint(FVector2D(Transform.GetLocation()));
+		Writer.SerializeIntPacked(ClassAndTurns);
+	}
+
+	for (const FDungeonCorridorSegment& Segment : Layout.Corridors)
+	{
+		uint32 ClassIndex = Segment.ClassIndex;
+
+		WritePoint(Segment.Start);
+		WritePoint(Segment.End);
+		Writer.SerializeIntPacked(ClassIndex);
+	}
+}
+
+/**
+ * Reads a layout written by EncodeLayout
+ * @param Blob - Encoded layout
+ * @param OutLayout - Receives the rooms and corridors, without triangulation nor MST
+ * @return bool - False if the blob is truncated or of another version
+ */
+bool ADungeonReplicator::DecodeLayout(const TArray<uint8>& Blob, FDungeonLayout& OutLayout)
+{
+	OutLayout.Reset();
+	FMemoryReader Reader(Blob);
+
+	uint8 Version = 0;
+	FVector2D Origin;
+	uint8 bMergedCorridors = 0;
+	uint32 NumRooms = 0;
+	uint32 NumCorridors = 0;
+	Reader << Version << OutLayout.Height << Origin.X << Origin.Y << bMergedCorridors;
+	Reader.SerializeIntPacked(NumRooms);
+	Reader.SerializeIntPacked(NumCorridors);
+
+	// Every room and corridor takes at least three bytes, reject counts the blob cannot hold before allocating
+	if (Reader.IsError() || Version != BlobVersion || (static_cast<int64>(NumRooms) + NumCorridors) * 3 > Blob.Num())
+	{
+		return false;
+	}
+
+	auto ReadPoint = [&Reader, &Origin]()
+	{
+		uint32 X = 0;
+		uint32 Y = 0;
+		Reader.SerializeIntPacked(X);
+		Reader.SerializeIntPacked(Y);
+		return FVector2D(Origin.X + X * QuantizationStep, Origin.Y + Y * QuantizationStep);
+	};
+
+	OutLayout.RoomTransforms.Reserve(NumRooms);
+	OutLayout.RoomClassIndices.Reserve(NumRooms);
+	for (uint32 i = 0; i < NumRooms; i++)
+	{
+		const FVector2D Location = ReadPoint();
+		uint32 ClassAndTurns = 0;
+		Reader.SerializeIntPacked(ClassAndTurns);
+
+		OutLayout.RoomTransforms.Add(FTransform(FRotator(0.f, (ClassAndTurns & 3) * 90.f, 0.f), FVector(Location, OutLayout.Height)));
+		OutLayout.RoomClassIndices.Add(static_cast<int32>(ClassAndTurns >> 2));
+	}
+
+	OutLayout.Corridors.Reserve(NumCorridors);
+	for (uint32 i = 0; i < NumCorridors; i++)
+	{
+		FDungeonCorridorSegment& Segment = OutLayout.Corridors.AddDefaulted_GetRef();
+		Segment.Start = ReadPoint();
+		Segment.End = ReadPoint();
+
+		uint32 ClassIndex = 0;
+		Reader.SerializeIntPacked(ClassIndex);
+		Segment.ClassIndex = static_cast<int32>(ClassIndex);
+	}
+
+	OutLayout.bMergedCorridors = bMergedCorridors != 0;
+	if (OutLayout.bMergedCorridors && !Reader.IsError())
+	{
+		UCorridorMerging::FindJunctions(OutLayout.Corridors, OutLayout.CorridorJunctions);
+	}
+
+	return !Reader.IsError();
+}
+
+void ADungeonReplicator::OnRep_Layout()
+{
+	TryApplyLayout();
+}
+
+/**
+ * Rebuilds the dungeon of the server on a client
+ * The header and the chunks arrive on different channels in any order, the layout is applied once all of them match
+ */
+void ADungeonReplicator::TryApplyLayout()
+{
+	if (ReplicatedLayout.Revision == AppliedRevision)
+	{
+		return;
+	}
+
+	UGameInstance* GameInstance = GetGameInstance();
+	UDungeonSubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UDungeonSubsystem>() : nullptr;
+	if (!Subsystem)
+	{
+		return;
+	}
+
+	const int32 NumChunks = ReplicatedLayout.NumChunks;
+	if (NumChunks <= 0 || NumChunks > MaxChunks)
+	{
+		AppliedRevision = ReplicatedLayout.Revision;
+		Subsystem->ClearDungeon();
+		return;
+	}
+
+	// Chunks of older revisions are still around until the server updates them
+	TArray<const ADungeonLayoutChunk*, TInlineAllocator<16>> ReceivedChunks;
+	ReceivedChunks.Init(nullptr, NumChunks);
+	for (TActorIterator<ADungeonLayoutChunk> It(GetWorld()); It; ++It)
+	{
+		const FDungeonReplicatedChunk& Chunk = It->Chunk;
+		if (It->GetOwner() == this && Chunk.Revision == ReplicatedLayout.Revision && ReceivedChunks.IsValidIndex(Chunk.Index))
+		{
+			ReceivedChunks[Chunk.Index] = *It;
+		}
+	}
+
+	TArray<uint8> Blob;
+	Blob.Reserve(FMath::Min(ReplicatedLayout.BlobSize, NumChunks * ChunkSize));
+	for (const ADungeonLayoutChunk* Chunk : ReceivedChunks)
+	{
+		if (!Chunk)
+		{
+			// Applied when the missing chunks arrive
+			return;
+		}
+		Blob.Append(Chunk->Chunk.Bytes);
+	}
+
+	AppliedRevision = ReplicatedLayout.Revision;
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	FDungeonLayout Layout;
+	if (Blob.Num() != ReplicatedLayout.BlobSize || !DecodeLayout(Blob, Layout))
+	{
+		UE_LOG(LogDungeon, Warning, TEXT("Ignoring invalid replicated dungeon layout %d"), ReplicatedLayout.Revision);
+		return;
+	}
+	Layout.Seed = ReplicatedLayout.Seed;
+
+	Subsystem->ApplyReplicatedLayout(Layout, RoomClasses, CorridorClasses);
+
+	UE_LOG(LogDungeon, Log, TEXT("Rebuilt replicated dungeon layout %d from %d bytes in %d chunks in %.2f ms"),
+		ReplicatedLayout.Revision, Blob.Num(), NumChunks, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
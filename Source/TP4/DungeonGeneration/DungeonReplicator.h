@@ -0,0 +1,167 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "RoomBase.h"
+#include "CorridorBase.h"
+#include "DungeonLayout.h"
+#include "DungeonReplicator.generated.h"
+
+/**
+ * Header of the quantized layout sent by the server
+ * The blob itself is split into ADungeonLayoutChunk actors, so no bunch gets larger than a chunk
+ */
+USTRUCT()
+struct FDungeonReplicatedLayout
+{
+	GENERATED_BODY()
+
+public:
+	// Incremented by the server for every published layout
+	UPROPERTY()
+	int32 Revision = 0;
+
+	UPROPERTY()
+	int32 Seed = 0;
+
+	// Number of chunks of the blob, zero once the dungeon is cleared
+	UPROPERTY()
+	int32 NumChunks = 0;
+
+	// Size of the blob encoded by ADungeonReplicator::EncodeLayout, checked once the chunks are joined
+	UPROPERTY()
+	int32 BlobSize = 0;
+};
+
+/**
+ * Consecutive bytes of a layout blob
+ */
+USTRUCT()
+struct FDungeonReplicatedChunk
+{
+	GENERATED_BODY()
+
+public:
+	// Revision of the layout the bytes belong to
+	UPROPERTY()
+	int32 Revision = 0;
+
+	// Position of the chunk in the blob
+	UPROPERTY()
+	int32 Index = 0;
+
+	// At most ADungeonReplicator::ChunkSize bytes
+	UPROPERTY()
+	TArray<uint8> Bytes;
+
+	// Bypasses the replicated array size limits, the chunk being sent whole
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FDungeonReplicatedChunk> : public TStructOpsTypeTraitsBase2<FDungeonReplicatedChunk>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+/**
+ * Replicates one chunk of a layout blob on its own actor channel
+ * Spawned and owned by the ADungeonReplicator of the server, which joins the chunks on clients
+ */
+UCLASS(NotBlueprintable, NotPlaceable)
+class TP4_API ADungeonLayoutChunk : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ADungeonLayoutChunk();
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	// The owning replicator can resolve after the chunk on clients
+	virtual void OnRep_Owner() override;
+
+	UPROPERTY(ReplicatedUsing = OnRep_Chunk)
+	FDungeonReplicatedChunk Chunk;
+
+private:
+
+	UFUNCTION()
+	void OnRep_Chunk();
+
+	void NotifyReplicator();
+};
+
+/**
+ * Replicates the dungeon layout instead of every room and corridor actor
+ * Spawned by the server when the layout is replicated, clients rebuild the dungeon locally from the layout
+ * The layout is a small replicated header plus one ADungeonLayoutChunk actor per ChunkSize bytes of the encoded layout,
+ * so large dungeons stay far below the size limit of reassembled partial bunches
+ */
+UCLASS(NotBlueprintable)
+class TP4_API ADungeonReplicator : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ADungeonReplicator();
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Server only, sends a layout and the classes it was generated with to every client
+	void SetLayout(const FDungeonLayout& Layout, const TArray<TSubclassOf<ARoomBase>>& InRoomClasses, const TArray<TSubclassOf<ACorridorBase>>& InCorridorClasses);
+
+	// Server only, clears the dungeon of every client
+	void ClearLayout();
+
+	// Quantizes the rooms and corridors of a layout, the triangulation and MST are not kept
+	static void EncodeLayout(const FDungeonLayout& Layout, TArray<uint8>& OutBlob);
+
+	// Rebuilds the layout of a blob, false if the blob is invalid
+	static bool DecodeLayout(const TArray<uint8>& Blob, FDungeonLayout& OutLayout);
+
+	// Client only, rebuilds the dungeon once the header and every chunk of its revision arrived
+	void TryApplyLayout();
+
+	// Precision of the replicated positions, in centimeters
+	static constexpr double QuantizationStep = 1.0;
+
+	// Largest chunk, half of the default net.MaxConstructedPartialBunchSizeBytes
+	static constexpr int32 ChunkSize = 32 * 1024;
+
+	// Largest number of chunks a client accepts, 32 MB of layout
+	static constexpr int32 MaxChunks = 1024;
+
+private:
+
+	UFUNCTION()
+	void OnRep_Layout();
+
+	// Server only, splits a blob into the chunk actors, reusing those of the previous layout
+	void PublishChunks(const TArray<uint8>& Blob);
+
+	UPROPERTY(Replicated)
+	TArray<TSubclassOf<ARoomBase>> RoomClasses;
+
+	UPROPERTY(Replicated)
+	TArray<TSubclassOf<ACorridorBase>> CorridorClasses;
+
+	UPROPERTY(ReplicatedUsing = OnRep_Layout)
+	FDungeonReplicatedLayout ReplicatedLayout;
+
+	// Server only, chunk actors of the current layout
+	UPROPERTY()
+	TArray<TObjectPtr<ADungeonLayoutChunk>> Chunks;
+
+	// Client only, revision of the last layout applied, so chunks arriving late don't rebuild it again
+	int32 AppliedRevision = 0;
+
+	// Bump when the blob encoding changes
+	static constexpr uint8 BlobVersion = 2;
+
+};
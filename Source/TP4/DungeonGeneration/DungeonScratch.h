@@ -0,0 +1,14 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/MemStack.h"
+
+/**
+ * Temporary array of the generation, allocated on the memory stack of the calling thread
+ * Everything allocated after an FMemMark is released at once when the mark goes out of scope, and the pages
+ * go back to the page pool rather than to the heap, so the next generation reuses them
+ * A scratch array must not outlive the mark it was allocated under: stages open their mark before their
+ * first temporary, and functions filling a scratch array given by their caller open none
+ */
+template<typename ElementType>
+using TDungeonScratchArray = TArray<ElementType, TMemStackAllocator<>>;
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+DECLARE_STATS_GROUP(TEXT("Dungeon"), STATGROUP_Dungeon, STATCAT_Advanced);
+
+/**
+ * Adds the time spent in its scope to a milliseconds counter
+ */
+struct SDungeonScopedTimer
+{
+public:
+    explicit SDungeonScopedTimer(double& InMilliseconds)
+        : Milliseconds(InMilliseconds)
+        , StartTime(FPlatformTime::Seconds())
+    {
+    }
+
+    ~SDungeonScopedTimer()
+    {
+        Milliseconds += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+    }
+
+private:
+    double& Milliseconds;
+    double StartTime;
+};
+
+// Cycle stat and Unreal Insights scope named after the stat
+#define DUNGEON_SCOPE(Stat) \
+    SCOPE_CYCLE_COUNTER(Stat); \
+    TRACE_CPUPROFILER_EVENT_SCOPE(Stat)
+
+// Same as DUNGEON_SCOPE, also adding the time of the scope to Milliseconds
+#define DUNGEON_TIMED_SCOPE(Stat, Milliseconds) \
+    DUNGEON_SCOPE(Stat); \
+    SDungeonScopedTimer ANONYMOUS_VARIABLE(DungeonTimer)(Milliseconds)
@@ -1,15 +1,30 @@
 ﻿#include "DungeonSubsystem.h"
-#include "DrawDebugHelpers.h"
-#include "Algo/RandomShuffle.h"
-#include "Triangulation.h"
-#include "MinSpanTree.h"
+#include "TP4.h"
+#include "DungeonStats.h"
+#include "DungeonLayoutCache.h"
+#include "DungeonReplicator.h"
+#include "CorridorMerging.h"
+#include "RoomSeparation.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_CYCLE_STAT(TEXT("Generate Dungeon"), STAT_DungeonGenerate, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Materialize"), STAT_DungeonMaterialize, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Materialize Tick"), STAT_DungeonMaterializeTick, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Streaming Tick"), STAT_DungeonStreamingTick, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Spawn Simulated Rooms"), STAT_DungeonSpawnSimulatedRooms, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Connect Simulated Rooms"), STAT_DungeonConnectSimulatedRooms, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Settle Check"), STAT_DungeonSettleCheck, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Add Room"), STAT_DungeonAddRoom, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Remove Room"), STAT_DungeonRemoveRoom, STATGROUP_Dungeon);
 
 /**
  * Main entry point for dungeon generation
  * Handles the complete process from room spawning to corridor creation
  */
-bool UDungeonSubsystem::GenerateDungeon(int Seed, TArray<TSubclassOf<ARoomBase>> RoomClasses, int RoomSpawned, TArray<TSubclassOf<ACorridorBase>> CorridorClasses, FVector DungeonPosition, FVector2D DungeonMinBounds, bool DrawBounds, bool DrawTriangulation, bool DrawMST, bool DrawCorridorLines)
+bool UDungeonSubsystem::GenerateDungeon(int Seed, const TArray<TSubclassOf<ARoomBase>>& RoomClasses, int RoomSpawned, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses, FVector DungeonPosition, FVector2D DungeonMinBounds, bool DrawBounds, bool DrawTriangulation, bool DrawMST, bool DrawCorridorLines)
 {
+    DUNGEON_SCOPE(STAT_DungeonGenerate);
+
     // Validate input
     if (RoomClasses.IsEmpty() || CorridorClasses.IsEmpty() || RoomSpawned <= 0
         || DungeonMinBounds.X < 0 || DungeonMinBounds.Y < 0)
@@ -17,361 +32,1957 @@ bool UDungeonSubsystem::GenerateDungeon(int Seed, TArray<TSubclassOf<ARoomBase>>
         return false;
     }
 
-    // Initialize random number generator with seed for reproducible results
-    FMath::RandInit(Seed);
+    // Return the previous dungeon to the actor pool
+    ClearDungeon();
 
     // Store parameters for later use
-    DungeonHeight = DungeonPosition.Z;
+    m_RoomClasses = RoomClasses;
     m_CorridorClasses = CorridorClasses;
-    m_DrawTriangulation = DrawTriangulation;
-    m_DrawMST = DrawMST;
-    m_DrawCorridorLines = DrawCorridorLines;
+    m_DebugBounds = FBox::BuildAABB(DungeonPosition, FVector(DungeonMinBounds, 0.0));
+    m_DebugLayers = static_cast<uint8>((DrawBounds ? GetDebugLayerBit(EDungeonDebugLayer::Bounds) : 0)
+        | (DrawTriangulation ? GetDebugLayerBit(EDungeonDebugLayer::Triangulation) : 0)
+        | (DrawMST ? GetDebugLayerBit(EDungeonDebugLayer::MST) : 0)
+        | (DrawCorridorLines ? GetDebugLayerBit(EDungeonDebugLayer::Corridors) | GetDebugLayerBit(EDungeonDebugLayer::Junctions) : 0));
+
+    const SDungeonLayoutParams Params = MakeLayoutParams(Seed, RoomClasses, RoomSpawned, CorridorClasses, DungeonPosition, DungeonMinBounds);
+
+    // Cached layouts have no triangulation nor MST to draw
+    const bool bUseCache = bUseLayoutCache && !DrawTriangulation && !DrawMST;
+
+    bool bHasLayout = false;
+    if (bUsePhysicsSeparation)
+    {
+        // A layout already settled by physics for the same parameters skips the simulation
+        SDungeonSettleSettings Settle;
+        Settle.Criterion = static_cast<uint8>(SettleCriterion);
+        Settle.MaxSpeed = SettleMaxSpeed;
+        Settle.MaxOverlapDepth = SettleMaxOverlapDepth;
+        m_LayoutCacheKey = UDungeonLayoutCache::ComputeKey(Params, &Settle);
+        m_bSaveLayoutToCache = bUseCache;
+        bHasLayout = bUseCache && UDungeonLayoutCache::Load(m_LayoutCacheKey, m_GeneratedLayout);
+    }
+    else
+    {
+        // Generate the whole layout on data
+        bHasLayout = LoadOrGenerateLayout(Params, bUseCache, m_GeneratedLayout);
+    }
+
+    if (bUsePhysicsSeparation && !bHasLayout)
+    {
+        // Spawn rooms at their initial positions and let the physics simulation separate them
+        m_GenerationStartTime = FPlatformTime::Seconds();
+        m_PhysicsStats = FDungeonGenerationStats();
+        m_LayoutParams = Params;
+        m_RandomStream.Initialize(Seed);
 
-    // Create initial room layout
-    m_Rooms = CreateRooms(RoomClasses, RoomSpawned, DungeonPosition, DungeonMinBounds);
+        // Footprints are only needed to spawn the rooms, the physics simulation moves them afterwards
+        FMemMark Mark(FMemStack::Get());
 
-    // Set up timer to check when physics simulation is complete
-    GetWorld()->GetTimerManager().SetTimer(SleepCheckHandle, this, &UDungeonSubsystem::CheckAllRoomsSleeping, 0.05f, true);
-    
-    // Safety timer in case physics simulation doesn't settle
-    GetWorld()->GetTimerManager().SetTimer(SafetyHandle, [this]()
+        TDungeonScratchArray<SRoomFootprint> Footprints;
+        Footprints.SetNumUninitialized(m_LayoutParams.RoomCount);
+        m_RoomClassIndices.SetNumUninitialized(m_LayoutParams.RoomCount);
         {
-            // Is called after 5 seconds if the rooms are still not sleeping
-            if (SleepCheckHandle.IsValid())
-            {
-                SleepCheckHandle.Invalidate();
-                OnAllRoomsSleep();
-            }
-        }, 5.0f, false);
+            SDungeonScopedTimer Timer(m_PhysicsStats.PlaceRoomsMs);
+            UDungeonLayoutGenerator::PlaceRooms(m_LayoutParams, m_RandomStream, m_RoomClassIndices, Footprints);
+        }
+
+        {
+            DUNGEON_TIMED_SCOPE(STAT_DungeonSpawnSimulatedRooms, m_PhysicsStats.SpawnMs);
+            CreateSimulatedRooms(m_RoomClassIndices, Footprints);
+        }
+
+        m_PhysicsStats.NumSpawnedRooms = m_Rooms.Num();
+        m_PhysicsStartTime = FPlatformTime::Seconds();
 
+        // Wait for the rooms to fall asleep, or to be settled enough
+        StartSettleDetection();
 
-    // Draw dungeon boundaries if requested
-    if (DrawBounds)
+        // Safety timer in case physics simulation doesn't settle
+        GetWorld()->GetTimerManager().SetTimer(SafetyHandle, [this]()
+            {
+                // Is called after 5 seconds if the rooms are still not settled, settling clears it
+                m_PhysicsStats.bSafetyTimeoutFired = true;
+                FinishSettle();
+            }, 5.0f, false);
+    }
+    else
     {
-        DrawDebugBox(GetWorld(), DungeonPosition, FVector(DungeonMinBounds, 0.f), FColor::Red, true, -1.f, 0, 1.f);
+        // Spawn the layout generated on data or read from the cache
+        SpawnLayout(m_GeneratedLayout, RoomClasses, CorridorClasses, DungeonPosition);
     }
-    
+
+    // Physics separation only draws the bounds until the rooms are sleeping
+    DrawDebugLayout();
+
     return true;
 }
 
-/**
- * Creates initial room layouts using physics simulation
- * Rooms are spawned with random positions and orientations
- * Physics simulation is used to resolve overlaps
- */
-TArray<ARoomBase*> UDungeonSubsystem::CreateRooms(const TArray<TSubclassOf<ARoomBase>>& RoomClasses, const int& RoomNumber, const FVector& DungeonPosition, const FVector2D& DungeonBounds)
+bool UDungeonSubsystem::GenerateDungeonLayout(int Seed, const TArray<TSubclassOf<ARoomBase>>& RoomClasses, int RoomSpawned, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses, FVector DungeonPosition, FVector2D DungeonMinBounds, FDungeonLayout& OutLayout)
+{
+    return LoadOrGenerateLayout(MakeLayoutParams(Seed, RoomClasses, RoomSpawned, CorridorClasses, DungeonPosition, DungeonMinBounds), bUseLayoutCache, OutLayout);
+}
+
+UDungeonGenerationHandle* UDungeonSubsystem::GenerateDungeonAsync(int Seed, const TArray<TSubclassOf<ARoomBase>>& RoomClasses, int RoomSpawned, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses, FVector DungeonPosition, FVector2D DungeonMinBounds)
+{
+    // Validate input
+    if (RoomClasses.IsEmpty() || CorridorClasses.IsEmpty() || RoomSpawned <= 0
+        || DungeonMinBounds.X < 0 || DungeonMinBounds.Y < 0)
+    {
+        return nullptr;
+    }
+
+    // Forget generations that already finished
+    m_AsyncGenerations.RemoveAll([](const UDungeonGenerationHandle* Handle) { return Handle->IsComplete(); });
+
+    // Room footprints are read from the class default objects here, the worker only sees plain data
+    UDungeonGenerationHandle* Handle = NewObject<UDungeonGenerationHandle>(this);
+    Handle->Start(MakeLayoutParams(Seed, RoomClasses, RoomSpawned, CorridorClasses, DungeonPosition, DungeonMinBounds));
+    m_AsyncGenerations.Add(Handle);
+
+    return Handle;
+}
+
+FDungeonBatchSummary UDungeonSubsystem::GenerateDungeonLayouts(const TArray<int32>& Seeds, const TArray<TSubclassOf<ARoomBase>>& RoomClasses, int RoomSpawned, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses, FVector DungeonPosition, FVector2D DungeonMinBounds, TArray<FDungeonLayout>& OutLayouts, TArray<FDungeonLayoutMetrics>& OutMetrics)
 {
-    TArray<ARoomBase*> SpawnedRooms;
-    // Define possible room rotations (0, 90, 180, 270 degrees)
-    TArray<float> PossibleAngles = { 0.f, 90.f, 180.f, 270.f };
+    // Room footprints are read once here, the workers only see plain data
+    const SDungeonLayoutParams Params = MakeLayoutParams(0, RoomClasses, RoomSpawned, CorridorClasses, DungeonPosition, DungeonMinBounds);
+    const FDungeonBatchSummary Summary = UDungeonLayoutGenerator::GenerateLayouts(Params, Seeds, OutLayouts, OutMetrics);
+
+    UE_LOG(LogDungeon, Log, TEXT("Generated %d dungeon layouts in %.1f ms, %d failed, %.1f rooms on average"),
+        Summary.NumLayouts, Summary.TotalTimeMs, Summary.NumFailed, Summary.AverageRooms);
+
+    return Summary;
+}
 
-    // First pass: Ensure at least one of each room type is spawned
-    Algo::RandomShuffle(RoomClasses);
-    for (int i = 0; i < FMath::Min(RoomNumber, RoomClasses.Num()); i++)
-    {  
-        // Randomly rotate the room
-        FRotator Rotation = FRotator(0.f, PossibleAngles[FMath::RandRange(0, PossibleAngles.Num() - 1)],0.f);
-        
-        // Spawn room at random position within bounds
-        ARoomBase* SpawnedRoom = GetWorld()->SpawnActor<ARoomBase>(RoomClasses[i],
-            FVector(DungeonPosition.X + FMath::FRandRange(-DungeonBounds.X, DungeonBounds.X),
-                    DungeonPosition.Y + FMath::FRandRange(-DungeonBounds.Y, DungeonBounds.Y),
-                    DungeonPosition.Z), Rotation);
+void UDungeonSubsystem::MaterializeLayout(const FDungeonLayout& Layout, const TArray<TSubclassOf<ARoomBase>>& RoomClasses, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses)
+{
+    // Respawning GetLayout passes m_Layout itself, which ClearDungeon resets
+    FDungeonLayout NewLayout = Layout;
+    ClearDungeon();
 
-        SpawnedRooms.Add(SpawnedRoom);
+    m_Layout = MoveTemp(NewLayout);
+    m_Layout.Stats.SpawnMs = 0.0;
+    m_RoomClasses = RoomClasses;
+    m_CorridorClasses = CorridorClasses;
+    {
+        DUNGEON_TIMED_SCOPE(STAT_DungeonMaterialize, m_Layout.Stats.SpawnMs);
+        CreateRooms(m_Layout, RoomClasses);
+        CreateCorridorInstances(CorridorClasses);
+        CreateCorridors(m_Layout, CorridorClasses);
     }
 
-    // Second pass: Fill remaining rooms with random types
-    for (int i = 0; i < RoomNumber - RoomClasses.Num(); i++)
+    LogMaterializationCounts();
+    LogGenerationStats();
+    PublishLayout();
+}
+
+void UDungeonSubsystem::MaterializeLayoutTimeSliced(const FDungeonLayout& Layout, const TArray<TSubclassOf<ARoomBase>>& RoomClasses, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses, FVector FocusPoint)
+{
+    // Respawning GetLayout passes m_Layout itself, which ClearDungeon resets
+    FDungeonLayout NewLayout = Layout;
+    ClearDungeon();
+
+    m_Layout = MoveTemp(NewLayout);
+    m_Layout.Stats.SpawnMs = 0.0;
+    m_RoomClasses = RoomClasses;
+    m_CorridorClasses = CorridorClasses;
+    m_Rooms.Reset(m_Layout.NumRooms());
+    m_Corridors.Reset(m_Layout.Corridors.Num());
+    m_RoomLayoutIndices.Reset(m_Layout.NumRooms());
+    m_CorridorLayoutIndices.Reset(m_Layout.Corridors.Num());
+    CreateCorridorInstances(CorridorClasses);
+
+    // Order every actor to spawn by distance to the focus point
+    const FVector2D Focus(FocusPoint);
+    m_MaterializeQueue.Reset(m_Layout.NumRooms() + m_Layout.Corridors.Num());
+
+    for (int32 i = 0; i < m_Layout.NumRooms(); i++)
     {
-        FRotator Rotation = FRotator(0.f, PossibleAngles[FMath::RandRange(0, PossibleAngles.Num() - 1)], 0.f);
-        ARoomBase* SpawnedRoom = GetWorld()->SpawnActor<ARoomBase>(RoomClasses[FMath::RandRange(0, RoomClasses.Num() - 1)],
-            FVector(DungeonPosition.X + FMath::FRandRange(-DungeonBounds.X, DungeonBounds.X),
-                    DungeonPosition.Y + FMath::FRandRange(-DungeonBounds.Y, DungeonBounds.Y),
-                    DungeonPosition.Z), Rotation);
+        m_MaterializeQueue.Add({ true, i, FVector2D::DistSquared(Focus, FVector2D(m_Layout.RoomTransforms[i].GetLocation())) });
+    }
 
-        SpawnedRooms.Add(SpawnedRoom);
+    for (int32 i = 0; i < m_Layout.Corridors.Num(); i++)
+    {
+        const FDungeonCorridorSegment& Segment = m_Layout.Corridors[i];
+        const FVector2D ClosestPoint = FMath::ClosestPointOnSegment2D(Focus, Segment.Start, Segment.End);
+        m_MaterializeQueue.Add({ false, i, FVector2D::DistSquared(Focus, ClosestPoint) });
     }
 
-    return SpawnedRooms;
+    m_MaterializeQueue.Sort([](const SMaterializeItem& A, const SMaterializeItem& B) { return A.DistanceSquared < B.DistanceSquared; });
+    m_MaterializeNext = 0;
+
+    m_MaterializeTicker = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UDungeonSubsystem::TickMaterialization));
+
+    PublishLayout();
 }
 
-/**
- * Called when all rooms have finished physics simulation
- * Handles the main dungeon generation steps:
- * 1. Removes overlapping rooms
- * 2. Gets key points for triangulation
- * 3. Creates Delaunay triangulation
- * 4. Generates minimum spanning tree
- * 5. Creates corridor layout
- * 6. Spawns final corridors
- */
-void UDungeonSubsystem::OnAllRoomsSleep()
+void UDungeonSubsystem::StreamLayout(const FDungeonLayout& Layout, const TArray<TSubclassOf<ARoomBase>>& RoomClasses, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses)
+{
+    // Respawning GetLayout passes m_Layout itself, which ClearDungeon resets
+    FDungeonLayout NewLayout = Layout;
+    ClearDungeon();
+
+    m_Layout = MoveTemp(NewLayout);
+    m_RoomClasses = RoomClasses;
+    m_CorridorClasses = CorridorClasses;
+
+    // Instances are cheap, only corridors spawned as actors are streamed
+    CreateCorridorInstances(CorridorClasses);
+    AddCorridorInstances(m_Layout);
+
+    // Index room bounds, read from the class footprints
+    TArray<SRoomFootprint> ClassFootprints;
+    for (const TSubclassOf<ARoomBase>& RoomClass : RoomClasses)
+    {
+        ClassFootprints.Add(GetRoomFootprint(RoomClass));
+    }
+
+    double CellSize = 0.0;
+    m_StreamRoomBounds.Reset(m_Layout.NumRooms());
+    for (int32 i = 0; i < m_Layout.NumRooms(); i++)
+    {
+        SRoomFootprint Footprint = ClassFootprints[m_Layout.RoomClassIndices[i]];
+        Footprint.Location = FVector2D(m_Layout.RoomTransforms[i].GetLocation());
+        Footprint.Yaw = m_Layout.RoomTransforms[i].Rotator().Yaw;
+        m_StreamRoomBounds.Add(Footprint.GetBounds());
+        CellSize = FMath::Max(CellSize, m_StreamRoomBounds.Last().GetSize().GetMax());
+    }
+    m_StreamRoomGrid.Build(m_StreamRoomBounds, CellSize);
+
+    // Index corridor segments spawned as actors
+    m_StreamCorridorLayoutIndices.Reset();
+    m_StreamCorridorBounds.Reset();
+    for (int32 i = 0; i < m_Layout.Corridors.Num(); i++)
+    {
+        const FDungeonCorridorSegment& Segment = m_Layout.Corridors[i];
+        if (!m_CorridorInstances || !m_CorridorInstances->IsInstanced(Segment.ClassIndex))
+        {
+            m_StreamCorridorLayoutIndices.Add(i);
+            m_StreamCorridorBounds.Add(FBox2D(FVector2D::Min(Segment.Start, Segment.End), FVector2D::Max(Segment.Start, Segment.End)));
+        }
+    }
+    m_StreamCorridorGrid.Build(m_StreamCorridorBounds, CellSize);
+
+    m_IsRoomStreamedIn.Init(false, m_Layout.NumRooms());
+    m_IsCorridorStreamedIn.Init(false, m_StreamCorridorLayoutIndices.Num());
+
+    m_StreamingTicker = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UDungeonSubsystem::TickStreaming), StreamingUpdateInterval);
+    TickStreaming(0.f);
+
+    LogGenerationStats();
+    PublishLayout();
+}
+
+void UDungeonSubsystem::ApplyReplicatedLayout(const FDungeonLayout& Layout, const TArray<TSubclassOf<ARoomBase>>& RoomClasses, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses)
+{
+    SpawnLayout(Layout, RoomClasses, CorridorClasses, FVector(0.0, 0.0, Layout.Height));
+}
+
+void UDungeonSubsystem::ClearLayoutCache()
 {
-    // Clean up rooms that ended up overlapping
-    RemoveOverlapedRooms(m_Rooms);
+    UDungeonLayoutCache::Clear();
+}
 
-    // Get key points for triangulation from room positions
-    TArray<FVector2D> Points = GetPoints(m_Rooms);
+ARoomBase* UDungeonSubsystem::AddRoom(int32 RoomClassIndex, FVector Location, int32 QuarterTurns)
+{
+    DUNGEON_SCOPE(STAT_DungeonAddRoom);
 
-    // Generate Delaunay triangulation
-    TArray<STriangle> Triangles = UTriangulation::GenerateTriangulation(Points);
+    const double StartTime = FPlatformTime::Seconds();
 
-    // Create minimum spanning tree from triangulation
-    TArray<TPair<FVector2D, FVector2D>> MST = UMinSpanTree::GenerateMST(Triangles);
+    if (!m_RoomClasses.IsValidIndex(RoomClassIndex) || !CanEditLive() || !BuildLiveGraph())
+    {
+        return nullptr;
+    }
 
-    // Generate L-shaped corridor paths
-    TArray<TPair<FVector2D, FVector2D>> CorridorLines = GenerateCorridorLines(MST);
+    TArray<SNodeEdge> AddedEdges;
+    TArray<SNodeEdge> RemovedEdges;
+    const int32 Node = m_LiveGraph.AddNode(FVector2D(Location), AddedEdges, RemovedEdges);
+    if (Node == INDEX_NONE)
+    {
+        UE_LOG(LogDungeon, Warning, TEXT("Can't add a room at %s, the location is already used or too far from the dungeon"), *Location.ToString());
+        return nullptr;
+    }
 
-    // Remove rooms that aren't connected by corridors
-    RemoveRoomsNotInCorridorLines(m_Rooms, CorridorLines);
+    const FTransform Transform(FRotator(0.f, (QuarterTurns & 3) * 90.f, 0.f), FVector(FVector2D(Location), m_Layout.Height));
+    AddLiveRoom(Transform, RoomClassIndex, Node);
 
-    // Create actual corridor actors
-    m_Corridors = CreateCorridors(CorridorLines);
+    int32 NumSpawnedCorridors = 0;
+    int32 NumReleasedCorridors = 0;
+    ApplyTreeChanges(AddedEdges, RemovedEdges, NumSpawnedCorridors, NumReleasedCorridors);
+
+    const int32 RoomSlot = m_RoomSlots.Last();
+    FinishLiveEdit(TEXT("Room added"), NumSpawnedCorridors, NumReleasedCorridors, StartTime);
+
+    return RoomSlot != INDEX_NONE ? m_Rooms[RoomSlot] : nullptr;
+}
+
+bool UDungeonSubsystem::RemoveRoom(ARoomBase* Room)
+{
+    DUNGEON_SCOPE(STAT_DungeonRemoveRoom);
+
+    const double StartTime = FPlatformTime::Seconds();
+
+    const int32 RoomSlot = m_Rooms.Find(Room);
+    if (RoomSlot == INDEX_NONE || !CanEditLive() || !BuildLiveGraph())
+    {
+        return false;
+    }
+
+    const int32 RoomIndex = m_RoomLayoutIndices[RoomSlot];
+    const int32 Node = m_RoomNodes[RoomIndex];
+
+    // Rooms that are not nodes of the tree have no corridor of their own
+    int32 NumSpawnedCorridors = 0;
+    int32 NumReleasedCorridors = 0;
+    if (Node != INDEX_NONE)
+    {
+        TArray<SNodeEdge> AddedEdges;
+        TArray<SNodeEdge> RemovedEdges;
+        m_LiveGraph.RemoveNode(Node, AddedEdges, RemovedEdges);
+        m_NodeRooms[Node] = INDEX_NONE;
+        ApplyTreeChanges(AddedEdges, RemovedEdges, NumSpawnedCorridors, NumReleasedCorridors);
+    }
+
+    RemoveLiveRoom(RoomIndex);
+
+    FinishLiveEdit(TEXT("Room removed"), NumSpawnedCorridors, NumReleasedCorridors, StartTime);
+
+    return true;
+}
+
+void UDungeonSubsystem::AddStreamingViewer(AActor* Viewer)
+{
+    m_StreamingViewers.AddUnique(Viewer);
+}
+
+void UDungeonSubsystem::RemoveStreamingViewer(AActor* Viewer)
+{
+    m_StreamingViewers.Remove(Viewer);
+}
+
+/**
+ * Removes the current dungeon
+ * Room and corridor actors are hidden and kept in the actor pool for the next generation
+ */
+void UDungeonSubsystem::ClearDungeon()
+{
+    StopMaterialization();
+    StopStreaming();
+
+    // Stop waiting for a physics separation in progress
+    StopSettleDetection();
 
-    // Disable room collision after generation
     for (ARoomBase* Room : m_Rooms)
     {
-        Room->RoomExtent->SetCollisionProfileName(FName("NoCollision"));
+        ReleaseRoom(Room);
     }
 
-    // Draw debug visualization if requested
-    if (m_DrawTriangulation)
+    for (ACorridorBase* Corridor : m_Corridors)
     {
-        // Draw triangulation lines
-        for (const auto& Triangle : Triangles)
-        {
-            FColor Color = FColor::Red;
-            DrawDebugLine(GetWorld(), FVector(Triangle.A, DungeonHeight + 100.f), FVector(Triangle.B, DungeonHeight + 100.f), Color, true, -1.f, 0, 5.f);
-            DrawDebugLine(GetWorld(), FVector(Triangle.B, DungeonHeight + 100.f), FVector(Triangle.C, DungeonHeight + 100.f), Color, true, -1.f, 0, 5.f);
-            DrawDebugLine(GetWorld(), FVector(Triangle.C, DungeonHeight + 100.f), FVector(Triangle.A, DungeonHeight + 100.f), Color, true, -1.f, 0, 5.f);
-        }
+        ReleaseActor(Corridor);
     }
 
-    if (m_DrawMST)
+    if (IsValid(m_CorridorInstances))
     {
-        // Draw minimum spanning tree edges
-        for (const auto& Edge : MST)
-        {
-            DrawDebugLine(GetWorld(), FVector(Edge.Key, DungeonHeight + 200.f), FVector(Edge.Value, DungeonHeight + 200.f), FColor::Green, true, -1.f, 0, 20.f);
-        }
+        m_CorridorInstances->Destroy();
     }
 
-    if (m_DrawCorridorLines)
+    if (IsValid(m_DebugDraw))
     {
-        // Draw final corridor paths
-        for (const auto& Corridor : CorridorLines)
-        {
-            DrawDebugLine(GetWorld(), FVector(Corridor.Key, DungeonHeight + 300.f), FVector(Corridor.Value, DungeonHeight + 300.f), FColor::Blue, true, -1.f, 0, 20.f);
-        }
+        m_DebugDraw->ClearLayers();
+    }
+
+    // Reset rather than emptied, the next dungeon reuses the allocations
+    m_Rooms.Reset();
+    m_Corridors.Reset();
+    m_CorridorInstances = nullptr;
+    m_RoomClassIndices.Reset();
+    m_Layout.Reset();
+
+    m_RoomLayoutIndices.Empty();
+    m_CorridorLayoutIndices.Empty();
+    m_LiveGraph.Reset();
+    m_RoomNodes.Empty();
+    m_NodeRooms.Empty();
+    m_EdgeCorridors.Empty();
+    m_CorridorEdges.Empty();
+    m_RoomSlots.Empty();
+    m_CorridorSlots.Empty();
+
+    if (IsReplicatingLayout() && IsValid(m_Replicator))
+    {
+        m_Replicator->ClearLayout();
+    }
+}
+
+void UDungeonSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    m_ActorPool = NewObject<UDungeonActorPool>(this);
+}
+
+void UDungeonSubsystem::Deinitialize()
+{
+    // Tickers, timers and room delegates would otherwise keep calling into the subsystem being destroyed
+    StopMaterialization();
+    StopStreaming();
+    StopSettleDetection();
+
+    // Running generations finish on their own, their result is dropped
+    for (UDungeonGenerationHandle* Handle : m_AsyncGenerations)
+    {
+        Handle->Cancel();
     }
+    m_AsyncGenerations.Empty();
+
+    Super::Deinitialize();
 }
 
 /**
- * Removes rooms that overlap with each other
- * Uses physics collision detection to find overlaps
- * @param Rooms - Array of rooms to check and clean up
+ * Gathers the plain data inputs of the layout generation
+ * Room footprints are read once per class from its default object
  */
-void UDungeonSubsystem::RemoveOverlapedRooms(TArray<ARoomBase*>& Rooms)
+SDungeonLayoutParams UDungeonSubsystem::MakeLayoutParams(int Seed, const TArray<TSubclassOf<ARoomBase>>& RoomClasses, int RoomNumber, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses, const FVector& DungeonPosition, const FVector2D& DungeonBounds) const
 {
-    TArray<ARoomBase*> RoomsToRemove;
+    SDungeonLayoutParams Params;
+    Params.Seed = Seed;
+    Params.NumCorridorClasses = CorridorClasses.Num();
+    Params.RoomCount = RoomNumber;
+    Params.Position = DungeonPosition;
+    Params.Bounds = DungeonBounds;
+    Params.SeparationMaxIterations = SeparationMaxIterations;
+    Params.bRouteCorridors = bRouteCorridors;
+    Params.CorridorCellSize = CorridorCellSize;
+    Params.bMergeCorridors = bMergeCorridors;
+    Params.GeometryPrecision = bSnapGeometryToGrid ? EGeometryPrecision::Fixed : EGeometryPrecision::Double;
 
-    // Check each room for validity and overlaps
-    for (ARoomBase* Room : Rooms)
+    Params.RoomFootprints.Reserve(RoomClasses.Num());
+    for (const TSubclassOf<ARoomBase>& RoomClass : RoomClasses)
     {
-        if (!IsValid(Room))
-        {
-            RoomsToRemove.Add(Room);
-            continue;
-        }
+        Params.RoomFootprints.Add(GetRoomFootprint(RoomClass));
+    }
 
-        // Disable physics and set up overlap checking
-        Room->RoomExtent->SetSimulatePhysics(false);
-        Room->RoomExtent->SetCollisionProfileName(FName("OverlapAll"));
+    return Params;
+}
+
+/**
+ * Reads the layout of a generation from the layout cache, or generates and stores it
+ * @param Params - Generation inputs
+ * @param bUseCache - Whether to use the layout cache
+ * @param OutLayout - Receives the layout
+ * @return bool - False if the parameters are invalid
+ */
+bool UDungeonSubsystem::LoadOrGenerateLayout(const SDungeonLayoutParams& Params, bool bUseCache, FDungeonLayout& OutLayout) const
+{
+    const uint64 CacheKey = UDungeonLayoutCache::ComputeKey(Params, nullptr);
+    if (bUseCache && UDungeonLayoutCache::Load(CacheKey, OutLayout))
+    {
+        return true;
+    }
+
+    if (!UDungeonLayoutGenerator::GenerateLayout(Params, OutLayout))
+    {
+        return false;
+    }
+
+    if (bUseCache)
+    {
+        UDungeonLayoutCache::Save(CacheKey, OutLayout);
+    }
 
-        // Check for overlapping rooms
-        TSet<AActor*> OverlapingActors;
-        Room->RoomExtent->GetOverlappingActors(OverlapingActors, ARoomBase::StaticClass());
+    return true;
+}
 
-        // Destroy overlapping rooms
-        for (AActor* OverlapingActor : OverlapingActors)
+/**
+ * Spawns a layout the way the settings ask for: streamed, time sliced or all at once
+ * @param Layout - Layout to spawn
+ * @param RoomClasses - Room types the layout was generated with
+ * @param CorridorClasses - Corridor types the layout was generated with
+ * @param DefaultFocusPoint - Where to start a time sliced materialization when there is no local player
+ */
+void UDungeonSubsystem::SpawnLayout(const FDungeonLayout& Layout, const TArray<TSubclassOf<ARoomBase>>& RoomClasses, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses, const FVector& DefaultFocusPoint)
+{
+    if (bStreamActors)
+    {
+        // Only spawn what is around the viewers
+        StreamLayout(Layout, RoomClasses, CorridorClasses);
+    }
+    else if (MaterializeFrameBudgetMs > 0.f)
+    {
+        // Spawn what the player sees first
+        FVector FocusPoint = DefaultFocusPoint;
+        if (const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController())
         {
-            if (OverlapingActor != Room)
-            {
-                OverlapingActor->Destroy();
-            }
+            FRotator ViewRotation;
+            PlayerController->GetPlayerViewPoint(FocusPoint, ViewRotation);
         }
+        MaterializeLayoutTimeSliced(Layout, RoomClasses, CorridorClasses, FocusPoint);
+    }
+    else
+    {
+        MaterializeLayout(Layout, RoomClasses, CorridorClasses);
     }
+}
+
+/**
+ * Spawns the rooms of a layout at their final positions
+ * m_Rooms receives the spawned rooms and m_RoomLayoutIndices their index in the layout
+ * @param Layout - Layout to spawn
+ * @param RoomClasses - Room types the layout was generated with
+ */
+void UDungeonSubsystem::CreateRooms(const FDungeonLayout& Layout, const TArray<TSubclassOf<ARoomBase>>& RoomClasses)
+{
+    m_Rooms.Reset(Layout.NumRooms());
+    m_RoomLayoutIndices.Reset(Layout.NumRooms());
 
-    // Remove invalid rooms from array
-    for (ARoomBase* RoomToRemove : RoomsToRemove)
+    for (int32 i = 0; i < Layout.NumRooms(); i++)
     {
-        Rooms.Remove(RoomToRemove);
+        if (ARoomBase* SpawnedRoom = SpawnRoom(Layout, i, RoomClasses))
+        {
+            m_Rooms.Add(SpawnedRoom);
+            m_RoomLayoutIndices.Add(i);
+        }
     }
 }
 
 /**
- * Selects key points for dungeon layout
- * Takes a subset of room positions to use as nodes
- * @param Rooms - Array of all dungeon rooms
- * @return Array of 2D points for triangulation
+ * Spawns one room of a layout
+ * Rooms are already separated, so they are spawned without simulating physics nor collision
+ * @param Layout - Layout holding the room
+ * @param RoomIndex - Index of the room in the layout
+ * @param RoomClasses - Room types the layout was generated with
+ * @return Spawned room, null if the spawn failed
  */
-TArray<FVector2D> UDungeonSubsystem::GetPoints(const TArray<ARoomBase*>& Rooms)
+ARoomBase* UDungeonSubsystem::SpawnRoom(const FDungeonLayout& Layout, int32 RoomIndex, const TArray<TSubclassOf<ARoomBase>>& RoomClasses)
 {
-    TArray<ARoomBase*> RoomsCopy = Rooms;
-    Algo::RandomShuffle(RoomsCopy);
+    const FTransform& Transform = Layout.RoomTransforms[RoomIndex];
+    const TSubclassOf<ARoomBase>& RoomClass = RoomClasses[Layout.RoomClassIndices[RoomIndex]];
 
-    TArray<FVector2D> Points;
+    if (!ShouldSpawnLocally(RoomClass))
+    {
+        return nullptr;
+    }
 
-    // Select a subset of rooms (at least 4, up to 1/4 of total rooms)
-    int32 NumPointsToGet = FMath::Max(4, RoomsCopy.Num() / 4);
-    NumPointsToGet = FMath::Min(NumPointsToGet, RoomsCopy.Num());
+    ARoomBase* SpawnedRoom = bUseActorPool ? m_ActorPool->Acquire(GetWorld(), RoomClass, Transform) : nullptr;
+    if (!SpawnedRoom)
+    {
+        SpawnedRoom = GetWorld()->SpawnActorDeferred<ARoomBase>(RoomClass, Transform);
+        if (SpawnedRoom)
+        {
+            SpawnedRoom->RoomExtent->SetSimulatePhysics(false);
+            SpawnedRoom->FinishSpawning(Transform);
+        }
+    }
 
-    // Get positions from selected rooms
-    for (int32 i = 0; i < NumPointsToGet; i++)
+    if (SpawnedRoom)
     {
-        Points.Add(FVector2D(RoomsCopy[i]->GetActorLocation()));
+        SpawnedRoom->RoomExtent->SetCollisionProfileName(FName("NoCollision"));
+        ApplyReplicationMode(SpawnedRoom);
     }
 
-    return Points;
+    return SpawnedRoom;
 }
 
 /**
- * Generates L-shaped corridor paths between rooms
- * Creates corridors by choosing random intermediate points
- * @param MST - Minimum spanning tree edges
- * @return Array of corridor line segments
+ * Spawns rooms at their initial, overlapping positions
+ * The physics simulation pushes them apart, the layout is generated once they are sleeping
+ * m_Rooms receives the spawned rooms
+ * @param ClassIndices - Room class of each room, removed in place for rooms that failed to spawn
+ * @param Footprints - Initial footprint of each room
  */
-TArray<TPair<FVector2D, FVector2D>> UDungeonSubsystem::GenerateCorridorLines(const TArray<TPair<FVector2D, FVector2D>>& MST)
+void UDungeonSubsystem::CreateSimulatedRooms(TArray<int32>& ClassIndices, TConstArrayView<SRoomFootprint> Footprints)
 {
-    TArray<TPair<FVector2D, FVector2D>> Corridors;
+    m_Rooms.Reset(Footprints.Num());
+    int32 NumSpawned = 0;
 
-    // Create L-shaped paths for each MST edge
-    for (const auto& Edge : MST)
+    for (int32 i = 0; i < Footprints.Num(); i++)
     {
-        // Randomly choose whether to go horizontal or vertical first
-        FVector2D IntermediatePoint = FMath::RandBool() ? FVector2D(Edge.Value.X, Edge.Key.Y) :
-                                               FVector2D(Edge.Key.X, Edge.Value.Y);
+        const FTransform Transform(FRotator(0.f, Footprints[i].Yaw, 0.f), FVector(Footprints[i].Location, m_LayoutParams.Position.Z));
+
+        ARoomBase* SpawnedRoom = bUseActorPool ? m_ActorPool->Acquire(GetWorld(), m_RoomClasses[ClassIndices[i]], Transform) : nullptr;
+        if (SpawnedRoom)
+        {
+            // Pooled rooms were frozen, give them back their simulation settings
+            SpawnedRoom->RoomExtent->SetCollisionProfileName(FName("PhysicsActor"), true);
+            SpawnedRoom->RoomExtent->SetSimulatePhysics(true);
+        }
+        else
+        {
+            SpawnedRoom = GetWorld()->SpawnActor<ARoomBase>(m_RoomClasses[ClassIndices[i]], Transform);
+        }
 
-        // Add both segments of the L-shaped path
-        Corridors.Add(TPair<FVector2D, FVector2D>(Edge.Key, IntermediatePoint));
-        Corridors.Add(TPair<FVector2D, FVector2D>(IntermediatePoint, Edge.Value));
+        if (SpawnedRoom)
+        {
+            ApplyReplicationMode(SpawnedRoom);
+            m_Rooms.Add(SpawnedRoom);
+            ClassIndices[NumSpawned++] = ClassIndices[i];
+        }
     }
 
-    return Corridors;
+    ClassIndices.SetNum(NumSpawned, EAllowShrinking::No);
 }
 
 /**
- * Removes rooms that aren't connected by corridors
- * Uses line traces to detect rooms along corridor paths
- * @param Rooms - Array of rooms to filter
- * @param CorridorLines - Corridor path segments
+ * Called when all rooms have finished physics simulation, or are settled enough
+ * Generates the rest of the layout from where the rooms settled and
+ * removes the rooms that are not part of it
  */
-void UDungeonSubsystem::RemoveRoomsNotInCorridorLines(TArray<ARoomBase*>& Rooms, TArray<TPair<FVector2D, FVector2D>> CorridorLines)
+void UDungeonSubsystem::OnAllRoomsSleep()
 {
-    // Set up collision for line traces
-    for (ARoomBase* Room : Rooms)
+    DUNGEON_SCOPE(STAT_DungeonConnectSimulatedRooms);
+
+    m_PhysicsStats.PhysicsSettleMs = (FPlatformTime::Seconds() - m_PhysicsStartTime) * 1000.0;
+
+    FMemMark Mark(FMemStack::Get());
+
+    TDungeonScratchArray<ARoomBase*> Rooms;
+    TDungeonScratchArray<int32> ClassIndices;
+    TDungeonScratchArray<SRoomFootprint> Footprints;
+    Rooms.Reserve(m_Rooms.Num());
+    ClassIndices.Reserve(m_Rooms.Num());
+    Footprints.Reserve(m_Rooms.Num());
+
+    for (int32 i = 0; i < m_Rooms.Num(); i++)
     {
-        Room->RoomExtent->SetCollisionProfileName(FName("BlockAll"));
+        // Skip rooms destroyed during the simulation
+        if (!IsValid(m_Rooms[i]))
+        {
+            continue;
+        }
+
+        // Freeze rooms where the physics simulation left them
+        m_Rooms[i]->RoomExtent->SetSimulatePhysics(false);
+        Rooms.Add(m_Rooms[i]);
+        ClassIndices.Add(m_RoomClassIndices[i]);
+        Footprints.Add(GetRoomFootprint(m_Rooms[i]));
     }
 
-    TArray<ARoomBase*> RoomsToKeep;
+    // Same stages as the headless generation, continuing the random stream of the placement
+    TDungeonScratchArray<int32> KeptRooms;
+    UDungeonLayoutGenerator::ConnectRooms(m_LayoutParams, m_RandomStream, ClassIndices, Footprints, m_Layout, KeptRooms);
+    m_Layout.Seed = m_LayoutParams.Seed;
+
+    // Add the stages that ran before the rooms were sleeping
+    FDungeonGenerationStats& Stats = m_Layout.Stats;
+    Stats.PlaceRoomsMs = m_PhysicsStats.PlaceRoomsMs;
+    Stats.PhysicsSettleMs = m_PhysicsStats.PhysicsSettleMs;
+    Stats.bSafetyTimeoutFired = m_PhysicsStats.bSafetyTimeoutFired;
+    Stats.bSettledBeforeSleep = m_PhysicsStats.bSettledBeforeSleep;
+    Stats.NumSpawnedRooms = m_PhysicsStats.NumSpawnedRooms;
+    Stats.SpawnMs = m_PhysicsStats.SpawnMs;
+    Stats.TotalMs = (FPlatformTime::Seconds() - m_GenerationStartTime) * 1000.0;
 
-    // Check each corridor line
-    for (const TPair<FVector2D, FVector2D>& Corridor : CorridorLines)
+    // A timed out simulation may have stopped anywhere, it is run again next time rather than cached
+    if (m_bSaveLayoutToCache && !m_PhysicsStats.bSafetyTimeoutFired)
     {
-        TArray<FHitResult> Hits;
+        UDungeonLayoutCache::Save(m_LayoutCacheKey, m_Layout);
+    }
 
-        // Trace in both directions to ensure we catch all rooms
-        if (GetWorld()->LineTraceMultiByChannel(Hits, FVector(Corridor.Key, DungeonHeight), FVector(Corridor.Value, DungeonHeight), ECollisionChannel::ECC_WorldDynamic))
-        {
-            for (const FHitResult& Hit : Hits)
-            {
-                if (ARoomBase* Room = Cast<ARoomBase>(Hit.GetActor()))
-                {
-                    RoomsToKeep.AddUnique(Room);
-                }
-            }
-        }
-        // Trace in reverse direction
-        if (GetWorld()->LineTraceMultiByChannel(Hits, FVector(Corridor.Value, DungeonHeight), FVector(Corridor.Key, DungeonHeight), ECollisionChannel::ECC_WorldDynamic))
-        {
-            for (const FHitResult& Hit : Hits)
-            {
-                if (ARoomBase* Room = Cast<ARoomBase>(Hit.GetActor()))
-                {
-                    RoomsToKeep.AddUnique(Room);
-                }
-            }
-        }
+    // Release rooms that are not part of the layout
+    TBitArray<TMemStackAllocator<>> IsKept(false, Rooms.Num());
+    m_Rooms.Reset(KeptRooms.Num());
+    m_RoomLayoutIndices.Reset(KeptRooms.Num());
+    for (int32 RoomIndex : KeptRooms)
+    {
+        // Kept rooms are in the order of the layout rooms
+        IsKept[RoomIndex] = true;
+        m_RoomLayoutIndices.Add(m_Rooms.Add(Rooms[RoomIndex]));
     }
 
-    // Remove rooms that aren't connected by corridors
-    for (int32 i = Rooms.Num() - 1; i >= 0; --i)
+    for (int32 i = 0; i < Rooms.Num(); i++)
     {
-        ARoomBase* Room = Rooms[i];
-        if (Room)
+        if (!IsKept[i])
         {
-            // Remove Room if it doesn't exist in ActorsToKeep
-            if (!RoomsToKeep.Contains(Room))
-            {
-                Rooms[i]->Destroy();
-                Rooms.RemoveAt(i);
-            }
+            ReleaseRoom(Rooms[i]);
         }
     }
+
+    // Create actual corridor actors
+    {
+        SDungeonScopedTimer Timer(Stats.SpawnMs);
+        CreateCorridorInstances(m_CorridorClasses);
+        CreateCorridors(m_Layout, m_CorridorClasses);
+    }
+
+    // Disable room collision after generation
+    for (ARoomBase* Room : m_Rooms)
+    {
+        Room->RoomExtent->SetCollisionProfileName(FName("NoCollision"));
+    }
+
+    DrawDebugLayout();
+    LogMaterializationCounts();
+    LogGenerationStats();
+    PublishLayout();
+    m_RoomClassIndices.Reset();
 }
 
 /**
  * Spawns corridor actors between connected rooms
- * Creates and scales corridor meshes along paths
- * @param CorridorLines - Corridor path segments
- * @return Array of spawned corridor actors
+ * Segments of instanced corridor classes are added to the corridor instances actor instead
+ * m_Corridors receives the spawned corridor actors and m_CorridorLayoutIndices their index in the layout
+ * @param Layout - Layout holding the corridor segments
+ * @param CorridorClasses - Corridor types the layout was generated with
  */
-TArray<ACorridorBase*> UDungeonSubsystem::CreateCorridors(TArray<TPair<FVector2D, FVector2D>> CorridorLines)
+void UDungeonSubsystem::CreateCorridors(const FDungeonLayout& Layout, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses)
 {
-    TArray<ACorridorBase*> Corridors;
+    AddCorridorInstances(Layout);
+
+    m_Corridors.Reset();
+    m_CorridorLayoutIndices.Reset();
 
-    // Create a corridor actor for each path segment
-    for (const TPair<FVector2D, FVector2D>& CorridorLine : CorridorLines)
+    // Create a corridor actor for each remaining path segment
+    for (int32 i = 0; i < Layout.Corridors.Num(); i++)
     {
-        // Randomly select corridor class
-        TSubclassOf<ACorridorBase> CorridorClass = m_CorridorClasses[FMath::RoundToInt(FMath::RandRange(0.f, m_CorridorClasses.Num() - 1.f))];
-        
-        // Calculate corridor transform
-        FVector Location = FVector(CorridorLine.Key, DungeonHeight);
-        FRotator Rotation = FVector(CorridorLine.Value - CorridorLine.Key, 0.f).ToOrientationRotator();
-        FVector Scale = FVector(FVector::Dist(FVector(CorridorLine.Key, 0.f), FVector(CorridorLine.Value, 0.f)) / 100.f, 1.f, 1.f);
-        if (ACorridorBase* Corridor = GetWorld()->SpawnActor<ACorridorBase>(CorridorClass, Location, Rotation))
+        if (m_CorridorInstances && m_CorridorInstances->IsInstanced(Layout.Corridors[i].ClassIndex))
         {
-            Corridor->SetActorScale3D(Scale);
-            Corridors.Add(Corridor);
+            continue;
+        }
+
+        if (ACorridorBase* Corridor = SpawnCorridor(Layout, i, CorridorClasses))
+        {
+            m_Corridors.Add(Corridor);
+            m_CorridorLayoutIndices.Add(i);
         }
-        
     }
-    return Corridors;
 }
 
 /**
- * Checks if physics simulation has completed
- * Called periodically until all rooms are stationary
+ * Adds every segment of instanced corridor classes to the corridor instances actor
+ * The instances of each class are added at once
+ * @param Layout - Layout holding the corridor segments
  */
-void UDungeonSubsystem::CheckAllRoomsSleeping()
+void UDungeonSubsystem::AddCorridorInstances(const FDungeonLayout& Layout)
 {
-    // Check if all rooms are sleeping
-    bool bAllSleeping = true;
-    for (const ARoomBase* Room : m_Rooms)
+    if (!m_CorridorInstances)
+    {
+        return;
+    }
+
+    TMap<int32, TArray<FTransform>> InstanceTransforms;
+    for (int32 i = 0; i < Layout.Corridors.Num(); i++)
     {
-        if (Room->RoomExtent->IsAnyRigidBodyAwake())
+        const int32 ClassIndex = Layout.Corridors[i].ClassIndex;
+        if (m_CorridorInstances->IsInstanced(ClassIndex))
         {
-            bAllSleeping = false;
-            break;
+            InstanceTransforms.FindOrAdd(ClassIndex).Add(GetCorridorTransform(Layout, i));
         }
     }
 
-    if (bAllSleeping && SleepCheckHandle.IsValid())
+    for (const TPair<int32, TArray<FTransform>>& ClassInstances : InstanceTransforms)
+    {
+        m_CorridorInstances->AddInstances(ClassInstances.Key, ClassInstances.Value);
+    }
+}
+
+/**
+ * Materializes one corridor segment of a layout
+ * Adds an instance for instanced corridor classes, spawns a scaled corridor actor otherwise
+ * @param Layout - Layout holding the corridor segments
+ * @param CorridorIndex - Index of the segment in the layout
+ * @param CorridorClasses - Corridor types the layout was generated with
+ * @return Spawned corridor, null if the segment was instanced or the spawn failed
+ */
+ACorridorBase* UDungeonSubsystem::SpawnCorridor(const FDungeonLayout& Layout, int32 CorridorIndex, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses)
+{
+    const int32 ClassIndex = Layout.Corridors[CorridorIndex].ClassIndex;
+    const FTransform Transform = GetCorridorTransform(Layout, CorridorIndex);
+
+    if (m_CorridorInstances && m_CorridorInstances->IsInstanced(ClassIndex))
+    {
+        m_CorridorInstances->AddInstances(ClassIndex, { Transform });
+        return nullptr;
+    }
+
+    if (!ShouldSpawnLocally(CorridorClasses[ClassIndex]))
     {
-        SleepCheckHandle.Invalidate();
-        OnAllRoomsSleep();
+        return nullptr;
     }
-}
\ No newline at end of file
+
+    ACorridorBase* Corridor = bUseActorPool ? m_ActorPool->Acquire(GetWorld(), CorridorClasses[ClassIndex], Transform) : nullptr;
+    if (!Corridor)
+    {
+        Corridor = GetWorld()->SpawnActor<ACorridorBase>(CorridorClasses[ClassIndex], Transform.GetLocation(), Transform.Rotator());
+        if (Corridor)
+        {
+            Corridor->SetActorScale3D(Transform.GetScale3D());
+        }
+    }
+
+    if (Corridor)
+    {
+        ApplyReplicationMode(Corridor);
+    }
+
+    return Corridor;
+}
+
+/**
+ * Spawns the actor holding instanced corridors if corridors are instanced
+ * @param CorridorClasses - Corridor types the layout was generated with
+ */
+void UDungeonSubsystem::CreateCorridorInstances(const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses)
+{
+    m_CorridorInstances = nullptr;
+
+    if (CorridorMode != EDungeonCorridorMode::Instanced)
+    {
+        return;
+    }
+
+    m_CorridorInstances = GetWorld()->SpawnActor<ADungeonCorridorInstances>();
+    if (m_CorridorInstances)
+    {
+        m_CorridorInstances->Initialize(CorridorClasses);
+    }
+}
+
+/**
+ * Spawns queued actors until the frame budget is spent
+ * At least one actor is spawned per frame so the materialization always progresses
+ * @param DeltaTime - Time since the last tick
+ * @return Whether to keep ticking
+ */
+bool UDungeonSubsystem::TickMaterialization(float DeltaTime)
+{
+    DUNGEON_SCOPE(STAT_DungeonMaterializeTick);
+
+    // The world may have been torn down since the materialization started
+    if (!GetWorld())
+    {
+        m_MaterializeTicker.Reset();
+        StopMaterialization();
+        return false;
+    }
+
+    const double StartTime = FPlatformTime::Seconds();
+    const double EndTime = StartTime + MaterializeFrameBudgetMs / 1000.0;
+
+    while (m_MaterializeNext < m_MaterializeQueue.Num())
+    {
+        const SMaterializeItem& Item = m_MaterializeQueue[m_MaterializeNext++];
+
+        if (Item.bIsRoom)
+        {
+            if (ARoomBase* Room = SpawnRoom(m_Layout, Item.Index, m_RoomClasses))
+            {
+                m_Rooms.Add(Room);
+                m_RoomLayoutIndices.Add(Item.Index);
+            }
+        }
+        else if (ACorridorBase* Corridor = SpawnCorridor(m_Layout, Item.Index, m_CorridorClasses))
+        {
+            m_Corridors.Add(Corridor);
+            m_CorridorLayoutIndices.Add(Item.Index);
+        }
+
+        if (FPlatformTime::Seconds() >= EndTime)
+        {
+            break;
+        }
+    }
+
+    m_Layout.Stats.SpawnMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+    const int32 NumSpawned = m_MaterializeNext;
+    const int32 NumTotal = m_MaterializeQueue.Num();
+    const bool bDone = NumSpawned == NumTotal;
+
+    // Clear the state before broadcasting, listeners may start another materialization
+    if (bDone)
+    {
+        m_MaterializeTicker.Reset();
+        m_MaterializeQueue.Empty();
+        m_MaterializeNext = 0;
+    }
+
+    OnMaterializeProgress.Broadcast(NumSpawned, NumTotal);
+
+    if (bDone)
+    {
+        LogMaterializationCounts();
+        LogGenerationStats();
+        OnMaterialized.Broadcast();
+    }
+
+    // Returning false removes the ticker
+    return !bDone;
+}
+
+/**
+ * Stops a time sliced materialization in progress, actors already spawned are kept
+ */
+void UDungeonSubsystem::StopMaterialization()
+{
+    if (m_MaterializeTicker.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(m_MaterializeTicker);
+        m_MaterializeTicker.Reset();
+    }
+
+    m_MaterializeQueue.Empty();
+    m_MaterializeNext = 0;
+}
+
+/**
+ * Starts waiting for the simulated rooms to settle
+ * Rooms report when their body wakes up or falls asleep, the separation completes once no room is awake
+ * A settle criterion other than Sleep is also checked every frame
+ */
+void UDungeonSubsystem::StartSettleDetection()
+{
+    m_SettleRoomIndices.Reset();
+    m_SettleRoomIndices.Reserve(m_Rooms.Num());
+    m_IsRoomAwake.Init(false, m_Rooms.Num());
+    m_NumAwakeRooms = 0;
+
+    for (int32 i = 0; i < m_Rooms.Num(); i++)
+    {
+        UBoxComponent* Body = m_Rooms[i]->RoomExtent;
+        m_SettleRoomIndices.Add(Body, i);
+        Body->OnComponentWake.AddDynamic(this, &UDungeonSubsystem::OnRoomWake);
+        Body->OnComponentSleep.AddDynamic(this, &UDungeonSubsystem::OnRoomSleep);
+
+        // Bodies only report changes, read the state they start with
+        if (Body->IsAnyRigidBodyAwake())
+        {
+            m_IsRoomAwake[i] = true;
+            m_NumAwakeRooms++;
+        }
+    }
+
+    if (m_NumAwakeRooms == 0)
+    {
+        SettledHandle = GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UDungeonSubsystem::FinishSettle);
+    }
+
+    if (SettleCriterion != EDungeonSettleCriterion::Sleep)
+    {
+        m_SettleTicker = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UDungeonSubsystem::TickSettle));
+    }
+}
+
+/**
+ * Stops waiting for the simulated rooms, the rooms stop reporting their sleep state
+ */
+void UDungeonSubsystem::StopSettleDetection()
+{
+    if (UWorld* World = GetWorld())
+    {
+        World->GetTimerManager().ClearTimer(SettledHandle);
+        World->GetTimerManager().ClearTimer(SafetyHandle);
+    }
+
+    if (m_SettleTicker.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(m_SettleTicker);
+        m_SettleTicker.Reset();
+    }
+
+    if (m_SettleRoomIndices.IsEmpty())
+    {
+        return;
+    }
+
+    for (ARoomBase* Room : m_Rooms)
+    {
+        if (IsValid(Room))
+        {
+            Room->RoomExtent->OnComponentWake.RemoveDynamic(this, &UDungeonSubsystem::OnRoomWake);
+            Room->RoomExtent->OnComponentSleep.RemoveDynamic(this, &UDungeonSubsystem::OnRoomSleep);
+        }
+    }
+
+    m_SettleRoomIndices.Reset();
+    m_IsRoomAwake.Empty();
+    m_NumAwakeRooms = 0;
+}
+
+void UDungeonSubsystem::OnRoomWake(UPrimitiveComponent* WakingComponent, FName BoneName)
+{
+    const int32* RoomIndex = m_SettleRoomIndices.Find(WakingComponent);
+    if (!RoomIndex || m_IsRoomAwake[*RoomIndex])
+    {
+        return;
+    }
+
+    m_IsRoomAwake[*RoomIndex] = true;
+    m_NumAwakeRooms++;
+
+    // A room pushed awake again cancels a completion planned for the next tick
+    GetWorld()->GetTimerManager().ClearTimer(SettledHandle);
+}
+
+void UDungeonSubsystem::OnRoomSleep(UPrimitiveComponent* SleepingComponent, FName BoneName)
+{
+    const int32* RoomIndex = m_SettleRoomIndices.Find(SleepingComponent);
+    if (!RoomIndex || !m_IsRoomAwake[*RoomIndex])
+    {
+        return;
+    }
+
+    m_IsRoomAwake[*RoomIndex] = false;
+
+    // Complete on the next tick rather than while the physics scene is dispatching its events,
+    // the rooms stop simulating when the layout is connected
+    if (--m_NumAwakeRooms == 0)
+    {
+        SettledHandle = GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UDungeonSubsystem::FinishSettle);
+    }
+}
+
+/**
+ * Checks the settle criterion once per frame
+ * @param DeltaTime - Time since the last tick
+ * @return Whether to keep ticking
+ */
+bool UDungeonSubsystem::TickSettle(float DeltaTime)
+{
+    DUNGEON_SCOPE(STAT_DungeonSettleCheck);
+
+    if (!IsSettledEnough())
+    {
+        return true;
+    }
+
+    // Returning false removes the ticker
+    m_SettleTicker.Reset();
+    m_PhysicsStats.bSettledBeforeSleep = true;
+    FinishSettle();
+    return false;
+}
+
+/**
+ * Whether the rooms are settled enough for the settle criterion, without waiting for them to sleep
+ * Residual speed only reads the awake rooms, overlap depth measures every room
+ */
+bool UDungeonSubsystem::IsSettledEnough() const
+{
+    switch (SettleCriterion)
+    {
+    case EDungeonSettleCriterion::ResidualSpeed:
+    {
+        const double MaxSpeedSquared = FMath::Square(static_cast<double>(SettleMaxSpeed));
+        for (TConstSetBitIterator<> It(m_IsRoomAwake); It; ++It)
+        {
+            const ARoomBase* Room = m_Rooms[It.GetIndex()];
+            if (IsValid(Room) && Room->RoomExtent->GetPhysicsLinearVelocity().SizeSquared() > MaxSpeedSquared)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    case EDungeonSettleCriterion::OverlapDepth:
+    {
+        TArray<SRoomFootprint> Footprints;
+        Footprints.Reserve(m_Rooms.Num());
+        for (const ARoomBase* Room : m_Rooms)
+        {
+            if (IsValid(Room))
+            {
+                Footprints.Add(GetRoomFootprint(Room));
+            }
+        }
+        return URoomSeparation::FindMaxOverlapDepth(Footprints) <= SettleMaxOverlapDepth;
+    }
+
+    default:
+        return false;
+    }
+}
+
+/**
+ * Stops the settle detection and connects the rooms where they are
+ */
+void UDungeonSubsystem::FinishSettle()
+{
+    StopSettleDetection();
+    OnAllRoomsSleep();
+}
+
+/**
+ * Reads the footprint of a room class from its default object
+ * @param RoomClass - Room class to read
+ * @return Footprint with extent and offset of the RoomExtent box, at the origin
+ */
+SRoomFootprint UDungeonSubsystem::GetRoomFootprint(TSubclassOf<ARoomBase> RoomClass)
+{
+    SRoomFootprint Footprint;
+
+    const ARoomBase* DefaultRoom = RoomClass ? RoomClass->GetDefaultObject<ARoomBase>() : nullptr;
+    if (DefaultRoom && DefaultRoom->RoomExtent)
+    {
+        const UBoxComponent* Box = DefaultRoom->RoomExtent;
+        Footprint.Extent = FVector2D(Box->GetUnscaledBoxExtent() * Box->GetRelativeScale3D());
+
+        // The box only has an offset when it is attached below another root
+        if (Box != DefaultRoom->GetRootComponent())
+        {
+            Footprint.Offset = FVector2D(Box->GetRelativeLocation());
+        }
+    }
+
+    return Footprint;
+}
+
+/**
+ * Reads the current footprint of a spawned room
+ * @param Room - Spawned room
+ * @return Footprint with the world extent of the RoomExtent box
+ */
+SRoomFootprint UDungeonSubsystem::GetRoomFootprint(const ARoomBase* Room)
+{
+    SRoomFootprint Footprint;
+    Footprint.Location = FVector2D(Room->GetActorLocation());
+    Footprint.Yaw = Room->GetActorRotation().Yaw;
+
+    if (const UBoxComponent* Box = Room->RoomExtent)
+    {
+        Footprint.Extent = FVector2D(Box->GetScaledBoxExtent());
+        Footprint.Offset = FVector2D(Room->GetActorTransform().InverseTransformPositionNoScale(Box->GetComponentLocation()));
+    }
+
+    return Footprint;
+}
+
+/**
+ * Shows or hides a debug layer, the lines of a shown layer are built from the current dungeon
+ * @param Layer - Layer to show or hide
+ * @param bVisible - Whether to draw the layer
+ */
+void UDungeonSubsystem::SetDebugLayerVisible(EDungeonDebugLayer Layer, bool bVisible)
+{
+    m_DebugLayers = static_cast<uint8>(bVisible ? (m_DebugLayers | GetDebugLayerBit(Layer)) : (m_DebugLayers & ~GetDebugLayerBit(Layer)));
+
+    DrawDebugLayer(Layer);
+}
+
+/**
+ * Draws every debug layer again, after the dungeon changed
+ */
+void UDungeonSubsystem::DrawDebugLayout()
+{
+    for (int32 Layer = 0; Layer < static_cast<int32>(EDungeonDebugLayer::Num); Layer++)
+    {
+        DrawDebugLayer(static_cast<EDungeonDebugLayer>(Layer));
+    }
+}
+
+/**
+ * Rebuilds the lines of a visible debug layer and submits them as one batch, hidden layers drop their lines
+ * The debug draw actor is only spawned once a layer is visible, and never in builds without debug drawing
+ * @param Layer - Layer to draw
+ */
+void UDungeonSubsystem::DrawDebugLayer(EDungeonDebugLayer Layer)
+{
+#if ENABLE_DRAW_DEBUG
+    const bool bVisible = IsDebugLayerVisible(Layer);
+
+    if (!IsValid(m_DebugDraw))
+    {
+        UWorld* World = GetWorld();
+        if (!bVisible || !World)
+        {
+            return;
+        }
+
+        m_DebugDraw = World->SpawnActor<ADungeonDebugDraw>();
+        if (!m_DebugDraw)
+        {
+            return;
+        }
+    }
+
+    TArray<FBatchedLine> Lines;
+    if (bVisible)
+    {
+        BuildDebugLines(Layer, Lines);
+    }
+
+    m_DebugDraw->SetLayerLines(Layer, MoveTemp(Lines));
+    m_DebugDraw->SetLayerVisible(Layer, bVisible);
+#endif
+}
+
+/**
+ * Builds the lines of a debug layer from the current dungeon, every edge being drawn once
+ * The triangulation uses the unique edges of the mesh rather than the three edges of each triangle,
+ * and corridors are merged so the segments several paths share are drawn once
+ * @param Layer - Layer to build
+ * @param OutLines - Receives the lines of the layer
+ */
+void UDungeonSubsystem::BuildDebugLines(EDungeonDebugLayer Layer, TArray<FBatchedLine>& OutLines) const
+{
+#if ENABLE_DRAW_DEBUG
+    const SDungeonMesh& Mesh = m_Layout.Mesh;
+    const double DungeonHeight = m_Layout.Height;
+
+    auto AddLine = [&OutLines](const FVector2D& Start, const FVector2D& End, double Height, const FLinearColor& Color, float Thickness)
+    {
+        OutLines.Emplace(FVector(Start, Height), FVector(End, Height), Color, 0.f, Thickness, SDPG_World);
+    };
+
+    switch (Layer)
+    {
+    case EDungeonDebugLayer::Bounds:
+        if (m_DebugBounds.IsValid)
+        {
+            const FVector2D Min(m_DebugBounds.Min);
+            const FVector2D Max(m_DebugBounds.Max);
+            const double Height = m_DebugBounds.Min.Z;
+            AddLine(Min, FVector2D(Max.X, Min.Y), Height, FLinearColor::Red, 1.f);
+            AddLine(FVector2D(Max.X, Min.Y), Max, Height, FLinearColor::Red, 1.f);
+            AddLine(Max, FVector2D(Min.X, Max.Y), Height, FLinearColor::Red, 1.f);
+            AddLine(FVector2D(Min.X, Max.Y), Min, Height, FLinearColor::Red, 1.f);
+        }
+        break;
+
+    case EDungeonDebugLayer::Triangulation:
+        OutLines.Reserve(Mesh.NumEdges());
+        for (int32 EdgeIndex = 0; EdgeIndex < Mesh.NumEdges(); EdgeIndex++)
+        {
+            AddLine(Mesh.GetEdgeStart(EdgeIndex), Mesh.GetEdgeEnd(EdgeIndex), DungeonHeight + 100.0, FLinearColor::Red, 5.f);
+        }
+        break;
+
+    case EDungeonDebugLayer::MST:
+        OutLines.Reserve(m_Layout.MST.Num());
+        for (int32 EdgeIndex : m_Layout.MST)
+        {
+            AddLine(Mesh.GetEdgeStart(EdgeIndex), Mesh.GetEdgeEnd(EdgeIndex), DungeonHeight + 200.0, FLinearColor::Green, 20.f);
+        }
+        break;
+
+    case EDungeonDebugLayer::Corridors:
+    {
+        TArray<FDungeonCorridorSegment> Segments = m_Layout.Corridors;
+        if (!m_Layout.bMergedCorridors)
+        {
+            UCorridorMerging::MergeCorridors(Segments);
+        }
+
+        OutLines.Reserve(Segments.Num());
+        for (const FDungeonCorridorSegment& Segment : Segments)
+        {
+            AddLine(Segment.Start, Segment.End, DungeonHeight + 300.0, FLinearColor::Blue, 20.f);
+        }
+        break;
+    }
+
+    case EDungeonDebugLayer::Junctions:
+        // A cross above each junction
+        OutLines.Reserve(m_Layout.CorridorJunctions.Num() * 2);
+        for (const FDungeonCorridorJunction& Junction : m_Layout.CorridorJunctions)
+        {
+            AddLine(Junction.Location - FVector2D(100.0, 100.0), Junction.Location + FVector2D(100.0, 100.0), DungeonHeight + 400.0, FLinearColor::Yellow, 20.f);
+            AddLine(Junction.Location - FVector2D(100.0, -100.0), Junction.Location + FVector2D(100.0, -100.0), DungeonHeight + 400.0, FLinearColor::Yellow, 20.f);
+        }
+        break;
+
+    default:
+        break;
+    }
+#endif
+}
+
+/**
+ * Computes the transform of a corridor segment
+ * Corridors start at the segment start, face the segment end and are scaled to its length
+ * @param Layout - Layout holding the corridor segments
+ * @param CorridorIndex - Index of the segment in the layout
+ * @return Transform of the corridor actor
+ */
+FTransform UDungeonSubsystem::GetCorridorTransform(const FDungeonLayout& Layout, int32 CorridorIndex)
+{
+    const FDungeonCorridorSegment& Segment = Layout.Corridors[CorridorIndex];
+
+    FVector Location = FVector(Segment.Start, Layout.Height);
+    FRotator Rotation = FVector(Segment.End - Segment.Start, 0.f).ToOrientationRotator();
+    FVector Scale = FVector(FVector2D::Distance(Segment.Start, Segment.End) / 100.f, 1.f, 1.f);
+
+    return FTransform(Rotation, Location, Scale);
+}
+
+/**
+ * Logs how many actors and components the materialized dungeon is made of
+ */
+void UDungeonSubsystem::LogMaterializationCounts() const
+{
+    int32 NumComponents = 0;
+    for (const ARoomBase* Room : m_Rooms)
+    {
+        NumComponents += Room->GetComponents().Num();
+    }
+    for (const ACorridorBase* Corridor : m_Corridors)
+    {
+        NumComponents += Corridor->GetComponents().Num();
+    }
+
+    int32 NumActors = m_Rooms.Num() + m_Corridors.Num();
+    int32 NumInstances = 0;
+    if (m_CorridorInstances)
+    {
+        NumActors++;
+        NumComponents += m_CorridorInstances->GetComponentCount();
+        NumInstances = m_CorridorInstances->GetInstanceCount();
+    }
+
+    UE_LOG(LogDungeon, Log, TEXT("Dungeon materialized: %d rooms, %d corridor actors, %d corridor instances, %d actors and %d components in total"),
+        m_Rooms.Num(), m_Corridors.Num(), NumInstances, NumActors, NumComponents);
+}
+
+/**
+ * Logs the time and counts of each stage of the current dungeon
+ */
+void UDungeonSubsystem::LogGenerationStats() const
+{
+    const FDungeonGenerationStats& Stats = m_Layout.Stats;
+
+    UE_LOG(LogDungeon, Log, TEXT("Dungeon generated%s in %.2f ms: place %.2f, separation %.2f, physics %.2f%s, overlaps %.2f, triangulation %.2f, MST %.2f, corridors %.2f, culling %.2f, merge %.2f, spawn %.2f"),
+        Stats.bLoadedFromCache ? TEXT(" from cache") : TEXT(""), Stats.TotalMs, Stats.PlaceRoomsMs, Stats.SeparationMs, Stats.PhysicsSettleMs,
+        Stats.bSafetyTimeoutFired ? TEXT(" (timed out)") : Stats.bSettledBeforeSleep ? TEXT(" (settled)") : TEXT(""),
+        Stats.OverlapRemovalMs, Stats.TriangulationMs, Stats.MSTMs, Stats.CorridorLinesMs, Stats.RoomCullingMs, Stats.CorridorMergeMs, Stats.SpawnMs);
+
+    UE_LOG(LogDungeon, Log, TEXT("Dungeon rooms: %d spawned, %d overlapped, %d disconnected, %d surviving, %d triangles, %d MST edges, %d corridor lines merged into %d corridors with %d junctions"),
+        Stats.NumSpawnedRooms, Stats.NumOverlappedRooms, Stats.NumDisconnectedRooms, Stats.NumSurvivingRooms,
+        Stats.NumTriangles, Stats.NumMSTEdges, Stats.NumCorridorLines, Stats.NumCorridors, Stats.NumCorridorJunctions);
+}
+
+/**
+ * Gives a room back to the actor pool, or destroys it when pooling is disabled
+ * @param Room - Room to release
+ */
+void UDungeonSubsystem::ReleaseRoom(ARoomBase* Room)
+{
+    if (IsValid(Room))
+    {
+        Room->RoomExtent->SetSimulatePhysics(false);
+        ReleaseActor(Room);
+    }
+}
+
+/**
+ * Gives an actor back to the actor pool, or destroys it when pooling is disabled
+ * @param Actor - Actor to release
+ */
+void UDungeonSubsystem::ReleaseActor(AActor* Actor)
+{
+    if (!IsValid(Actor))
+    {
+        return;
+    }
+
+    if (bUseActorPool)
+    {
+        m_ActorPool->Release(Actor);
+    }
+    else
+    {
+        Actor->Destroy();
+    }
+}
+
+/**
+ * Whether the server replicates the layout instead of the room and corridor actors
+ */
+bool UDungeonSubsystem::IsReplicatingLayout() const
+{
+    const UWorld* World = GetWorld();
+    if (ReplicationMode != EDungeonReplicationMode::Layout || !World)
+    {
+        return false;
+    }
+
+    const ENetMode NetMode = World->GetNetMode();
+    return NetMode == NM_ListenServer || NetMode == NM_DedicatedServer;
+}
+
+/**
+ * Whether this machine spawns an actor of the layout
+ * Clients receive the actors with gameplay state from the server
+ * @param ActorClass - Room or corridor class
+ */
+bool UDungeonSubsystem::ShouldSpawnLocally(TSubclassOf<AActor> ActorClass) const
+{
+    const UWorld* World = GetWorld();
+    return !World || World->GetNetMode() != NM_Client || !HasGameplayState(ActorClass);
+}
+
+/**
+ * Stops replicating a spawned actor when the layout is replicated, unless it has gameplay state
+ * Clients spawn their own copy of these actors from the layout
+ * @param Actor - Spawned room or corridor
+ */
+void UDungeonSubsystem::ApplyReplicationMode(AActor* Actor) const
+{
+    if (IsReplicatingLayout() && !HasGameplayState(Actor->GetClass()))
+    {
+        Actor->SetReplicates(false);
+    }
+}
+
+/**
+ * Sends the current layout to the clients when the layout is replicated
+ * The dungeon replicator is spawned the first time
+ */
+void UDungeonSubsystem::PublishLayout()
+{
+    if (!IsReplicatingLayout())
+    {
+        return;
+    }
+
+    if (!IsValid(m_Replicator))
+    {
+        m_Replicator = GetWorld()->SpawnActor<ADungeonReplicator>();
+        if (!m_Replicator)
+        {
+            return;
+        }
+    }
+
+    m_Replicator->SetLayout(m_Layout, m_RoomClasses, m_CorridorClasses);
+
+    // Each actor left replicated still opens an actor channel on every client
+    int32 NumReplicatedActors = 0;
+    for (const ARoomBase* Room : m_Rooms)
+    {
+        NumReplicatedActors += Room->GetIsReplicated() ? 1 : 0;
+    }
+    for (const ACorridorBase* Corridor : m_Corridors)
+    {
+        NumReplicatedActors += Corridor->GetIsReplicated() ? 1 : 0;
+    }
+
+    UE_LOG(LogDungeon, Log, TEXT("Dungeon layout replicated, %d room and corridor actors with gameplay state still replicated"), NumReplicatedActors);
+}
+
+/**
+ * Reads whether a room or corridor class keeps gameplay state, from its default object
+ * @param ActorClass - Room or corridor class
+ */
+bool UDungeonSubsystem::HasGameplayState(TSubclassOf<AActor> ActorClass)
+{
+    const AActor* DefaultActor = ActorClass ? ActorClass.GetDefaultObject() : nullptr;
+
+    if (const ARoomBase* Room = Cast<ARoomBase>(DefaultActor))
+    {
+        return Room->bHasGameplayState;
+    }
+
+    if (const ACorridorBase* Corridor = Cast<ACorridorBase>(DefaultActor))
+    {
+        return Corridor->bHasGameplayState;
+    }
+
+    return false;
+}
+
+/**
+ * Whether rooms can be added to or removed from the current dungeon
+ * The dungeon has to be completely spawned, and edits are made by the server when the layout is replicated
+ */
+bool UDungeonSubsystem::CanEditLive() const
+{
+    const UWorld* World = GetWorld();
+    const bool bIsLayoutClient = World && World->GetNetMode() == NM_Client && ReplicationMode == EDungeonReplicationMode::Layout;
+    const bool bIsWaitingForPhysics = m_RoomClassIndices.Num() > 0;
+
+    if (!World || m_Layout.NumRooms() == 0 || IsStreaming() || IsMaterializing() || bIsWaitingForPhysics || bIsLayoutClient)
+    {
+        UE_LOG(LogDungeon, Warning, TEXT("Rooms can only be added or removed once the dungeon is completely spawned, and by the server when the layout is replicated"));
+        return false;
+    }
+
+    if (m_Layout.bMergedCorridors)
+    {
+        UE_LOG(LogDungeon, Warning, TEXT("Rooms can't be added or removed once corridors are merged, the corridors of each tree edge are no longer known"));
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Builds the live graph of the current dungeon the first time it is edited
+ * Nodes and tree edges are read back from the corridors, two segments per tree edge from the start room to the end room,
+ * so layouts read from the cache or received from the server can be edited as well
+ * @return Whether the graph is built
+ */
+bool UDungeonSubsystem::BuildLiveGraph()
+{
+    if (m_LiveGraph.IsBuilt())
+    {
+        return true;
+    }
+
+    const int32 NumRooms = m_Layout.NumRooms();
+    const int32 NumCorridors = m_Layout.Corridors.Num();
+
+    TMap<FVector2D, int32> RoomAtLocation;
+    FBox2D Area(ForceInit);
+    RoomAtLocation.Reserve(NumRooms);
+    for (int32 i = 0; i < NumRooms; i++)
+    {
+        const FVector2D Location(m_Layout.RoomTransforms[i].GetLocation());
+        RoomAtLocation.Add(Location, i);
+        Area += Location;
+    }
+
+    // Corridors are consecutive per tree edge, layouts that do not say how many per edge are made of L-shapes
+    TArray<int32> PathStarts;
+    if (m_Layout.CorridorPathSegments.Num() > 0)
+    {
+        int32 PathStart = 0;
+        for (int32 NumSegments : m_Layout.CorridorPathSegments)
+        {
+            PathStarts.Add(PathStart);
+            PathStart += NumSegments;
+        }
+        PathStarts.Add(PathStart);
+    }
+    else
+    {
+        for (int32 i = 0; i + 1 < NumCorridors; i += 2)
+        {
+            PathStarts.Add(i);
+        }
+        PathStarts.Add(PathStarts.Num() * 2);
+    }
+    const int32 NumPaths = PathStarts.Num() - 1;
+
+    // Every tree edge becomes a node pair, nodes being the rooms at the ends of its path
+    TArray<FVector2D> Points;
+    TArray<int32> PointRooms;
+    TArray<SNodeEdge> TreeEdges;
+    TMap<FVector2D, int32> PointAtLocation;
+    for (int32 Path = 0; Path < NumPaths; Path++)
+    {
+        int32 Ends[2];
+        const FVector2D EndLocations[2] = { m_Layout.Corridors[PathStarts[Path]].Start, m_Layout.Corridors[PathStarts[Path + 1] - 1].End };
+        for (int32 End = 0; End < 2; End++)
+        {
+            if (const int32* Point = PointAtLocation.Find(EndLocations[End]))
+            {
+                Ends[End] = *Point;
+                continue;
+            }
+
+            const int32* Room = RoomAtLocation.Find(EndLocations[End]);
+            Ends[End] = Points.Add(EndLocations[End]);
+            PointRooms.Add(Room ? *Room : INDEX_NONE);
+            PointAtLocation.Add(EndLocations[End], Ends[End]);
+        }
+        TreeEdges.Add(SNodeEdge(Ends[0], Ends[1]));
+    }
+
+    // Nodes can be added up to the size of the dungeon away from it
+    TArray<int32> Nodes;
+    m_LiveGraph.Build(Points, TreeEdges, Area.ExpandBy(FMath::Max(Area.GetExtent().GetMax(), 1000.0)), Nodes);
+    m_LiveStream.Initialize(static_cast<int32>(HashCombine(GetTypeHash(m_Layout.Seed), GetTypeHash(NumRooms))));
+
+    m_RoomNodes.Init(INDEX_NONE, NumRooms);
+    m_NodeRooms.Reset();
+    for (int32 i = 0; i < Points.Num(); i++)
+    {
+        if (Nodes[i] == INDEX_NONE)
+        {
+            continue;
+        }
+
+        while (m_NodeRooms.Num() <= Nodes[i])
+        {
+            m_NodeRooms.Add(INDEX_NONE);
+        }
+
+        m_NodeRooms[Nodes[i]] = PointRooms[i];
+        if (PointRooms[i] != INDEX_NONE)
+        {
+            m_RoomNodes[PointRooms[i]] = Nodes[i];
+        }
+    }
+
+    m_EdgeCorridors.Reset();
+    m_CorridorEdges.Init(0, NumCorridors);
+    for (int32 Path = 0; Path < NumPaths; Path++)
+    {
+        const SNodeEdge& Edge = TreeEdges[Path];
+        const uint64 Key = SNodeEdge(Nodes[Edge.A], Nodes[Edge.B]).GetKey();
+        TArray<int32, TInlineAllocator<2>>& Corridors = m_EdgeCorridors.FindOrAdd(Key);
+        for (int32 i = PathStarts[Path]; i < PathStarts[Path + 1]; i++)
+        {
+            Corridors.Add(i);
+            m_CorridorEdges[i] = Key;
+        }
+    }
+
+    m_RoomSlots.Init(INDEX_NONE, NumRooms);
+    for (int32 Slot = 0; Slot < m_RoomLayoutIndices.Num(); Slot++)
+    {
+        m_RoomSlots[m_RoomLayoutIndices[Slot]] = Slot;
+    }
+
+    m_CorridorSlots.Init(INDEX_NONE, NumCorridors);
+    for (int32 Slot = 0; Slot < m_CorridorLayoutIndices.Num(); Slot++)
+    {
+        m_CorridorSlots[m_CorridorLayoutIndices[Slot]] = Slot;
+    }
+
+    // The debug triangulation, MST and corridor paths no longer match the dungeon once edited
+    m_Layout.Mesh.Reset();
+    m_Layout.MST.Reset();
+    m_Layout.CorridorPathSegments.Reset();
+
+    return m_LiveGraph.IsBuilt();
+}
+
+/**
+ * Releases the corridors of the tree edges removed by an edit and spawns the corridors of the added ones
+ * Instances of a corridor class can't be removed one by one, the classes that lost a segment are rebuilt
+ * before the new segments are added
+ * @param AddedEdges - Tree edges added by the edit
+ * @param RemovedEdges - Tree edges removed by the edit
+ * @param OutNumSpawned - Number of corridor segments added
+ * @param OutNumReleased - Number of corridor segments removed
+ */
+void UDungeonSubsystem::ApplyTreeChanges(const TArray<SNodeEdge>& AddedEdges, const TArray<SNodeEdge>& RemovedEdges, int32& OutNumSpawned, int32& OutNumReleased)
+{
+    TSet<int32> DirtyInstanceClasses;
+    for (const SNodeEdge& Edge : RemovedEdges)
+    {
+        TArray<int32, TInlineAllocator<2>> Corridors;
+        if (!m_EdgeCorridors.RemoveAndCopyValue(Edge.GetKey(), Corridors))
+        {
+            continue;
+        }
+
+        // Highest index first, removing a corridor moves the last one into its place
+        Corridors.Sort(TGreater<int32>());
+        for (int32 CorridorIndex : Corridors)
+        {
+            RemoveLiveCorridor(CorridorIndex, DirtyInstanceClasses);
+        }
+        OutNumReleased += Corridors.Num();
+    }
+
+    if (m_CorridorInstances)
+    {
+        for (int32 ClassIndex : DirtyInstanceClasses)
+        {
+            TArray<FTransform> Transforms;
+            for (int32 i = 0; i < m_Layout.Corridors.Num(); i++)
+            {
+                if (m_Layout.Corridors[i].ClassIndex == ClassIndex)
+                {
+                    Transforms.Add(GetCorridorTransform(m_Layout, i));
+                }
+            }
+
+            m_CorridorInstances->ClearInstances(ClassIndex);
+            m_CorridorInstances->AddInstances(ClassIndex, Transforms);
+        }
+    }
+
+    TArray<TPair<FVector2D, FVector2D>, TInlineAllocator<2>> Lines;
+    for (const SNodeEdge& Edge : AddedEdges)
+    {
+        Lines.Reset();
+        UDungeonLayoutGenerator::AddCorridorLines(m_LiveGraph.GetNodePosition(Edge.A), m_LiveGraph.GetNodePosition(Edge.B), m_LiveStream, Lines);
+
+        TArray<int32, TInlineAllocator<2>>& Corridors = m_EdgeCorridors.Add(Edge.GetKey());
+        for (const TPair<FVector2D, FVector2D>& Line : Lines)
+        {
+            FDungeonCorridorSegment Segment;
+            Segment.Start = Line.Key;
+            Segment.End = Line.Value;
+            Segment.ClassIndex = m_LiveStream.RandRange(0, m_CorridorClasses.Num() - 1);
+
+            const int32 CorridorIndex = m_Layout.Corridors.Add(Segment);
+            Corridors.Add(CorridorIndex);
+            m_CorridorEdges.Add(Edge.GetKey());
+
+            ACorridorBase* Corridor = SpawnCorridor(m_Layout, CorridorIndex, m_CorridorClasses);
+            m_CorridorSlots.Add(Corridor ? m_Corridors.Add(Corridor) : INDEX_NONE);
+            if (Corridor)
+            {
+                m_CorridorLayoutIndices.Add(CorridorIndex);
+            }
+        }
+        OutNumSpawned += Lines.Num();
+    }
+}
+
+/**
+ * Appends a room to the layout of the current dungeon and spawns it
+ * @param Transform - Transform of the room
+ * @param RoomClassIndex - Index of the room type
+ * @param Node - Live graph node of the room
+ */
+void UDungeonSubsystem::AddLiveRoom(const FTransform& Transform, int32 RoomClassIndex, int32 Node)
+{
+    const int32 RoomIndex = m_Layout.RoomTransforms.Add(Transform);
+    m_Layout.RoomClassIndices.Add(RoomClassIndex);
+    m_RoomNodes.Add(Node);
+
+    while (m_NodeRooms.Num() <= Node)
+    {
+        m_NodeRooms.Add(INDEX_NONE);
+    }
+    m_NodeRooms[Node] = RoomIndex;
+
+    ARoomBase* Room = SpawnRoom(m_Layout, RoomIndex, m_RoomClasses);
+    m_RoomSlots.Add(Room ? m_Rooms.Add(Room) : INDEX_NONE);
+    if (Room)
+    {
+        m_RoomLayoutIndices.Add(RoomIndex);
+    }
+}
+
+/**
+ * Releases a room of the current dungeon and removes it from the layout
+ * The last layout room takes its index, every array referring to it is patched
+ * @param RoomIndex - Index of the room in the layout
+ */
+void UDungeonSubsystem::RemoveLiveRoom(int32 RoomIndex)
+{
+    const int32 Slot = m_RoomSlots[RoomIndex];
+    if (Slot != INDEX_NONE)
+    {
+        ReleaseRoom(m_Rooms[Slot]);
+        m_Rooms.RemoveAtSwap(Slot);
+        m_RoomLayoutIndices.RemoveAtSwap(Slot);
+        if (Slot < m_Rooms.Num())
+        {
+            m_RoomSlots[m_RoomLayoutIndices[Slot]] = Slot;
+        }
+    }
+
+    m_Layout.RoomTransforms.RemoveAtSwap(RoomIndex);
+    m_Layout.RoomClassIndices.RemoveAtSwap(RoomIndex);
+    m_RoomSlots.RemoveAtSwap(RoomIndex);
+    m_RoomNodes.RemoveAtSwap(RoomIndex);
+
+    if (RoomIndex < m_Layout.NumRooms())
+    {
+        if (m_RoomSlots[RoomIndex] != INDEX_NONE)
+        {
+            m_RoomLayoutIndices[m_RoomSlots[RoomIndex]] = RoomIndex;
+        }
+        if (m_RoomNodes[RoomIndex] != INDEX_NONE)
+        {
+            m_NodeRooms[m_RoomNodes[RoomIndex]] = RoomIndex;
+        }
+    }
+}
+
+/**
+ * Releases a corridor of the current dungeon and removes it from the layout
+ * The last layout corridor takes its index, every array referring to it is patched
+ * @param CorridorIndex - Index of the corridor in the layout
+ * @param OutDirtyInstanceClasses - Receives the class of the corridor if it was instanced
+ */
+void UDungeonSubsystem::RemoveLiveCorridor(int32 CorridorIndex, TSet<int32>& OutDirtyInstanceClasses)
+{
+    const int32 Slot = m_CorridorSlots[CorridorIndex];
+    if (Slot != INDEX_NONE)
+    {
+        ReleaseActor(m_Corridors[Slot]);
+        m_Corridors.RemoveAtSwap(Slot);
+        m_CorridorLayoutIndices.RemoveAtSwap(Slot);
+        if (Slot < m_Corridors.Num())
+        {
+            m_CorridorSlots[m_CorridorLayoutIndices[Slot]] = Slot;
+        }
+    }
+    else if (m_CorridorInstances && m_CorridorInstances->IsInstanced(m_Layout.Corridors[CorridorIndex].ClassIndex))
+    {
+        OutDirtyInstanceClasses.Add(m_Layout.Corridors[CorridorIndex].ClassIndex);
+    }
+
+    const int32 LastIndex = m_Layout.Corridors.Num() - 1;
+    m_Layout.Corridors.RemoveAtSwap(CorridorIndex);
+    m_CorridorSlots.RemoveAtSwap(CorridorIndex);
+    m_CorridorEdges.RemoveAtSwap(CorridorIndex);
+
+    if (CorridorIndex < LastIndex)
+    {
+        if (m_CorridorSlots[CorridorIndex] != INDEX_NONE)
+        {
+            m_CorridorLayoutIndices[m_CorridorSlots[CorridorIndex]] = CorridorIndex;
+        }
+        if (TArray<int32, TInlineAllocator<2>>* EdgeCorridors = m_EdgeCorridors.Find(m_CorridorEdges[CorridorIndex]))
+        {
+            EdgeCorridors->Remove(LastIndex);
+            EdgeCorridors->Add(CorridorIndex);
+        }
+    }
+}
+
+/**
+ * Updates the counts of the edited dungeon, sends it to the clients when the layout is replicated and logs the edit
+ * Clients receive the whole layout again, the server only spawned and released what changed
+ * @param Operation - Name of the edit for the log
+ * @param NumSpawnedCorridors - Number of corridor segments added
+ * @param NumReleasedCorridors - Number of corridor segments removed
+ * @param StartTime - When the edit started
+ */
+void UDungeonSubsystem::FinishLiveEdit(const TCHAR* Operation, int32 NumSpawnedCorridors, int32 NumReleasedCorridors, double StartTime)
+{
+    m_Layout.Stats.NumSurvivingRooms = m_Layout.NumRooms();
+    m_Layout.Stats.NumCorridorLines = m_Layout.Corridors.Num();
+    m_Layout.Stats.NumCorridors = m_Layout.Corridors.Num();
+    m_Layout.Stats.NumMSTEdges = m_EdgeCorridors.Num();
+
+    PublishLayout();
+    DrawDebugLayout();
+
+    UE_LOG(LogDungeon, Log, TEXT("%s in %.3f ms: %d corridors spawned, %d released, %d rooms and %d corridors in the dungeon"),
+        Operation, (FPlatformTime::Seconds() - StartTime) * 1000.0, NumSpawnedCorridors, NumReleasedCorridors, m_Layout.NumRooms(), m_Layout.Corridors.Num());
+}
+
+/**
+ * Spawns the rooms and corridors close to a viewer and releases the ones far from every viewer
+ * Actors are released beyond StreamingRadius + StreamingHysteresis, so moving around the radius does not thrash
+ * @param DeltaTime - Time since the last update
+ * @return Whether to keep updating
+ */
+bool UDungeonSubsystem::TickStreaming(float DeltaTime)
+{
+    DUNGEON_SCOPE(STAT_DungeonStreamingTick);
+
+    if (!GetWorld())
+    {
+        m_StreamingTicker.Reset();
+        StopStreaming();
+        return false;
+    }
+
+    // Gather viewer positions, the local players view points when no viewer is registered
+    TArray<FVector2D> Viewers;
+    m_StreamingViewers.RemoveAll([](const TWeakObjectPtr<AActor>& Viewer) { return !Viewer.IsValid(); });
+    for (const TWeakObjectPtr<AActor>& Viewer : m_StreamingViewers)
+    {
+        Viewers.Add(FVector2D(Viewer->GetActorLocation()));
+    }
+
+    if (Viewers.IsEmpty())
+    {
+        for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+        {
+            if (const APlayerController* PlayerController = It->Get())
+            {
+                FVector ViewLocation;
+                FRotator ViewRotation;
+                PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+                Viewers.Add(FVector2D(ViewLocation));
+            }
+        }
+    }
+
+    const double LoadRadiusSquared = FMath::Square(StreamingRadius);
+    const double UnloadRadiusSquared = FMath::Square(StreamingRadius + StreamingHysteresis);
+
+    auto IsWithin = [&Viewers](const FBox2D& Bounds, double RadiusSquared)
+    {
+        for (const FVector2D& Viewer : Viewers)
+        {
+            if (Bounds.ComputeSquaredDistanceToPoint(Viewer) <= RadiusSquared)
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // Release actors far from every viewer, m_Rooms and m_Corridors are kept parallel to the streamed in indices
+    for (int32 i = m_StreamedRoomIndices.Num() - 1; i >= 0; --i)
+    {
+        const int32 RoomIndex = m_StreamedRoomIndices[i];
+        if (!IsWithin(m_StreamRoomBounds[RoomIndex], UnloadRadiusSquared))
+        {
+            ReleaseRoom(m_Rooms[i]);
+            m_Rooms.RemoveAtSwap(i);
+            m_StreamedRoomIndices.RemoveAtSwap(i);
+            m_IsRoomStreamedIn[RoomIndex] = false;
+        }
+    }
+
+    for (int32 i = m_StreamedCorridorIndices.Num() - 1; i >= 0; --i)
+    {
+        const int32 StreamIndex = m_StreamedCorridorIndices[i];
+        if (!IsWithin(m_StreamCorridorBounds[StreamIndex], UnloadRadiusSquared))
+        {
+            ReleaseActor(m_Corridors[i]);
+            m_Corridors.RemoveAtSwap(i);
+            m_StreamedCorridorIndices.RemoveAtSwap(i);
+            m_IsCorridorStreamedIn[StreamIndex] = false;
+        }
+    }
+
+    // Spawn what entered the radius, within the frame budget if there is one
+    const double EndTime = FPlatformTime::Seconds() + MaterializeFrameBudgetMs / 1000.0;
+    bool bOutOfBudget = false;
+
+    for (const FVector2D& Viewer : Viewers)
+    {
+        const FBox2D QueryBox(Viewer - FVector2D(StreamingRadius), Viewer + FVector2D(StreamingRadius));
+
+        m_StreamRoomGrid.ForEachInBox(QueryBox, [&](int32 RoomIndex)
+        {
+            if (bOutOfBudget || m_IsRoomStreamedIn[RoomIndex] || m_StreamRoomBounds[RoomIndex].ComputeSquaredDistanceToPoint(Viewer) > LoadRadiusSquared)
+            {
+                return;
+            }
+
+            // Only spawned actors are marked, so the unload loop clears every flag it set and failed spawns are tried again
+            if (ARoomBase* Room = SpawnRoom(m_Layout, RoomIndex, m_RoomClasses))
+            {
+                m_IsRoomStreamedIn[RoomIndex] = true;
+                m_Rooms.Add(Room);
+                m_StreamedRoomIndices.Add(RoomIndex);
+            }
+            bOutOfBudget = MaterializeFrameBudgetMs > 0.f && FPlatformTime::Seconds() >= EndTime;
+        });
+
+        m_StreamCorridorGrid.ForEachInBox(QueryBox, [&](int32 StreamIndex)
+        {
+            if (bOutOfBudget || m_IsCorridorStreamedIn[StreamIndex] || m_StreamCorridorBounds[StreamIndex].ComputeSquaredDistanceToPoint(Viewer) > LoadRadiusSquared)
+            {
+                return;
+            }
+
+            if (ACorridorBase* Corridor = SpawnCorridor(m_Layout, m_StreamCorridorLayoutIndices[StreamIndex], m_CorridorClasses))
+            {
+                m_IsCorridorStreamedIn[StreamIndex] = true;
+                m_Corridors.Add(Corridor);
+                m_StreamedCorridorIndices.Add(StreamIndex);
+            }
+            bOutOfBudget = MaterializeFrameBudgetMs > 0.f && FPlatformTime::Seconds() >= EndTime;
+        });
+    }
+
+    return true;
+}
+
+/**
+ * Stops updating streamed actors, actors already spawned are kept
+ */
+void UDungeonSubsystem::StopStreaming()
+{
+    if (m_StreamingTicker.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(m_StreamingTicker);
+        m_StreamingTicker.Reset();
+    }
+
+    m_StreamRoomBounds.Empty();
+    m_StreamCorridorBounds.Empty();
+    m_StreamCorridorLayoutIndices.Empty();
+    m_StreamedRoomIndices.Empty();
+    m_StreamedCorridorIndices.Empty();
+    m_IsRoomStreamedIn.Empty();
+    m_IsCorridorStreamedIn.Empty();
+}
@@ -2,10 +2,79 @@
 
 #include "CoreMinimal.h"
 #include "Subsystems/GameInstanceSubsystem.h"
+#include "Containers/Ticker.h"
+#include <atomic>
 #include "RoomBase.h"
 #include "CorridorBase.h"
+#include "DungeonCorridorInstances.h"
+#include "DungeonDebugDraw.h"
+#include "DungeonActorPool.h"
+#include "DungeonLayout.h"
+#include "DungeonLayoutGenerator.h"
+#include "DungeonGenerationHandle.h"
+#include "DungeonLiveGraph.h"
+#include "RoomGeometry.h"
 #include "DungeonSubsystem.generated.h"
 
+/**
+ * How corridor segments are materialized
+ */
+UENUM(BlueprintType)
+enum class EDungeonCorridorMode : uint8
+{
+    // One corridor actor per segment
+    Actors,
+    // One instance per segment in a single actor, classes without an InstancedMesh are still spawned as actors
+    Instanced
+};
+
+/**
+ * How a dungeon generated by the server reaches the clients
+ */
+UENUM(BlueprintType)
+enum class EDungeonReplicationMode : uint8
+{
+    // Rooms and corridors replicate as their classes are set to
+    Actors,
+    // The server replicates the layout once and clients spawn rooms and corridors locally, only those with gameplay state replicate
+    Layout
+};
+
+/**
+ * When the physics separation may stop before every room is asleep
+ * Rooms still overlapping once it stops are removed like with the separation solver
+ */
+UENUM(BlueprintType)
+enum class EDungeonSettleCriterion : uint8
+{
+    // Wait until every room sleeps
+    Sleep,
+    // Also stop once every awake room is slower than SettleMaxSpeed
+    ResidualSpeed,
+    // Also stop once no two rooms overlap deeper than SettleMaxOverlapDepth
+    OverlapDepth
+};
+
+class ADungeonReplicator;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnDungeonMaterializeProgress, int32, NumSpawned, int32, NumTotal);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnDungeonMaterialized);
+
+/**
+ * Room or corridor waiting to be spawned by the time sliced materialization
+ */
+struct SMaterializeItem
+{
+public:
+    bool bIsRoom;
+
+    // Index in the layout rooms or corridors
+    int32 Index;
+
+    // Priority, closest to the focus point first
+    double DistanceSquared;
+};
+
 UCLASS()
 class TP4_API UDungeonSubsystem : public UGameInstanceSubsystem 
 {
@@ -24,50 +93,449 @@ public:
      * @param DrawBounds - Whether to draw debug bounds
      * @param DrawTriangulation - Whether to draw debug triangulation
      * @param DrawMST - Whether to draw minimum spanning tree
-     * @param DrawCorridorLines - Whether to draw corridor debug lines
+     * @param DrawCorridorLines - Whether to draw corridor debug lines, and junctions when corridors are merged
      * @return bool - Success/failure of dungeon generation
      */
     UFUNCTION(BlueprintCallable, Category = "Dungeon Generation")
-    bool GenerateDungeon(int Seed, TArray<TSubclassOf<ARoomBase>> RoomClasses, int RoomSpawned, TArray<TSubclassOf<ACorridorBase>> CorridorClasses, FVector DungeonPosition, FVector2D DungeonMinBounds, bool DrawBounds, bool DrawTriangulation, bool DrawMST, bool DrawCorridorLines);
+    bool GenerateDungeon(int Seed, const TArray<TSubclassOf<ARoomBase>>& RoomClasses, int RoomSpawned, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses, FVector DungeonPosition, FVector2D DungeonMinBounds, bool DrawBounds, bool DrawTriangulation, bool DrawMST, bool DrawCorridorLines);
 
+    /**
+     * Generates the layout of a dungeon without spawning anything
+     * Rooms are always separated by the deterministic solver, the same inputs give the same layout
+     * Reads the layout from the layout cache when enabled and already generated
+     * @param Seed - Random seed for dungeon generation
+     * @param RoomClasses - Array of room types to place
+     * @param RoomSpawned - Total number of rooms to place
+     * @param CorridorClasses - Array of corridor types to use
+     * @param DungeonPosition - Center position of the dungeon
+     * @param DungeonMinBounds - Minimum X,Y bounds for room placement
+     * @param OutLayout - Generated rooms and corridors, class indices refer to RoomClasses and CorridorClasses
+     * @return bool - Success/failure of layout generation
+     */
     UFUNCTION(BlueprintCallable, Category = "Dungeon Generation")
-    TArray<ARoomBase*> GetRooms() { return m_Rooms; }
+    bool GenerateDungeonLayout(int Seed, const TArray<TSubclassOf<ARoomBase>>& RoomClasses, int RoomSpawned, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses, FVector DungeonPosition, FVector2D DungeonMinBounds, FDungeonLayout& OutLayout);
 
+    /**
+     * Generates the layout of a dungeon on worker threads
+     * Rooms are always separated by the deterministic solver, the game thread only reads the room classes
+     * @param Seed - Random seed for dungeon generation
+     * @param RoomClasses - Array of room types to place
+     * @param RoomSpawned - Total number of rooms to place
+     * @param CorridorClasses - Array of corridor types to use
+     * @param DungeonPosition - Center position of the dungeon
+     * @param DungeonMinBounds - Minimum X,Y bounds for room placement
+     * @return Handle to poll or cancel the generation, its OnLayoutGenerated fires on the game thread. Null if the inputs are invalid
+     */
+    UFUNCTION(BlueprintCallable, Category = "Dungeon Generation")
+    UDungeonGenerationHandle* GenerateDungeonAsync(int Seed, const TArray<TSubclassOf<ARoomBase>>& RoomClasses, int RoomSpawned, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses, FVector DungeonPosition, FVector2D DungeonMinBounds);
+
+    /**
+     * Generates one layout per seed, in parallel on worker threads, and waits for all of them
+     * Each generation has its own random stream, a seed always gives the same layout as GenerateDungeonLayout
+     * @param Seeds - Seed of each layout
+     * @param RoomClasses - Array of room types to place
+     * @param RoomSpawned - Total number of rooms to place in each layout
+     * @param CorridorClasses - Array of corridor types to use
+     * @param DungeonPosition - Center position of the dungeons
+     * @param DungeonMinBounds - Minimum X,Y bounds for room placement
+     * @param OutLayouts - One layout per seed, without debug data
+     * @param OutMetrics - Room count, corridor length and generation time of each layout
+     * @return Summary of the batch
+     */
+    UFUNCTION(BlueprintCallable, Category = "Dungeon Generation")
+    FDungeonBatchSummary GenerateDungeonLayouts(const TArray<int32>& Seeds, const TArray<TSubclassOf<ARoomBase>>& RoomClasses, int RoomSpawned, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses, FVector DungeonPosition, FVector2D DungeonMinBounds, TArray<FDungeonLayout>& OutLayouts, TArray<FDungeonLayoutMetrics>& OutMetrics);
+
+    /**
+     * Spawns the rooms and corridors of a layout
+     * @param Layout - Layout to spawn
+     * @param RoomClasses - Room types the layout was generated with
+     * @param CorridorClasses - Corridor types the layout was generated with
+     */
+    UFUNCTION(BlueprintCallable, Category = "Dungeon Generation")
+    void MaterializeLayout(const FDungeonLayout& Layout, const TArray<TSubclassOf<ARoomBase>>& RoomClasses, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses);
+
+    /**
+     * Spawns the rooms and corridors of a layout over several frames
+     * Each frame spawns actors until MaterializeFrameBudgetMs is spent, closest to the focus point first
+     * Replaces a time sliced materialization still in progress
+     * @param Layout - Layout to spawn
+     * @param RoomClasses - Room types the layout was generated with
+     * @param CorridorClasses - Corridor types the layout was generated with
+     * @param FocusPoint - Rooms and corridors closest to this point are spawned first
+     */
     UFUNCTION(BlueprintCallable, Category = "Dungeon Generation")
-    TArray<ACorridorBase*> GetCorridors() { return m_Corridors; }
+    void MaterializeLayoutTimeSliced(const FDungeonLayout& Layout, const TArray<TSubclassOf<ARoomBase>>& RoomClasses, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses, FVector FocusPoint);
+
+    /**
+     * Keeps a layout as data and only spawns the rooms and corridors within StreamingRadius of a viewer
+     * Actors are released to the actor pool once beyond StreamingRadius + StreamingHysteresis of every viewer
+     * Instanced corridors are all added at once and not streamed
+     * @param Layout - Layout to stream
+     * @param RoomClasses - Room types the layout was generated with
+     * @param CorridorClasses - Corridor types the layout was generated with
+     */
+    UFUNCTION(BlueprintCallable, Category = "Dungeon Generation")
+    void StreamLayout(const FDungeonLayout& Layout, const TArray<TSubclassOf<ARoomBase>>& RoomClasses, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses);
+
+    /** Tracks an actor for streaming, the local players view points are used when no viewer is tracked */
+    UFUNCTION(BlueprintCallable, Category = "Dungeon Generation")
+    void AddStreamingViewer(AActor* Viewer);
+
+    UFUNCTION(BlueprintCallable, Category = "Dungeon Generation")
+    void RemoveStreamingViewer(AActor* Viewer);
+
+    UFUNCTION(BlueprintPure, Category = "Dungeon Generation")
+    bool IsStreaming() const { return m_StreamingTicker.IsValid(); }
+
+    UFUNCTION(BlueprintPure, Category = "Dungeon Generation")
+    bool IsMaterializing() const { return m_MaterializeTicker.IsValid(); }
+
+    /**
+     * Spawns a layout received from the server, called on clients by the dungeon replicator
+     * Rooms and corridors with gameplay state are skipped, the server replicates them
+     * @param Layout - Layout of the server
+     * @param RoomClasses - Room types the layout was generated with
+     * @param CorridorClasses - Corridor types the layout was generated with
+     */
+    void ApplyReplicatedLayout(const FDungeonLayout& Layout, const TArray<TSubclassOf<ARoomBase>>& RoomClasses, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses);
+
+    /**
+     * Adds a room to the current dungeon and connects it with corridors
+     * The spanning tree is repaired around the room, only the corridors of the tree edges that changed are spawned or released
+     * The room is not checked for overlaps with the existing rooms
+     * @param RoomClassIndex - Index of the room type in the classes the dungeon was generated with
+     * @param Location - Center of the room, Z is ignored
+     * @param QuarterTurns - Rotation of the room, in quarter turns
+     * @return The spawned room, null if the dungeon can't be edited or the location is already used or too far from the dungeon
+     */
+    UFUNCTION(BlueprintCallable, Category = "Dungeon Generation")
+    ARoomBase* AddRoom(int32 RoomClassIndex, FVector Location, int32 QuarterTurns);
+
+    /**
+     * Removes a room from the current dungeon
+     * The rooms it was connecting are joined again, only the corridors of the tree edges that changed are spawned or released
+     * Rooms only kept because a released corridor went through them stay in place
+     * @param Room - Room of the current dungeon
+     * @return Whether the room was removed
+     */
+    UFUNCTION(BlueprintCallable, Category = "Dungeon Generation")
+    bool RemoveRoom(ARoomBase* Room);
+
+    /** Deletes every layout stored by the layout cache */
+    UFUNCTION(BlueprintCallable, Category = "Dungeon Generation")
+    static void ClearLayoutCache();
+
+    /** Broadcast after each frame of a time sliced materialization */
+    UPROPERTY(BlueprintAssignable, Category = "Dungeon Generation")
+    FOnDungeonMaterializeProgress OnMaterializeProgress;
+
+    /** Broadcast once a time sliced materialization spawned every actor */
+    UPROPERTY(BlueprintAssignable, Category = "Dungeon Generation")
+    FOnDungeonMaterialized OnMaterialized;
+
+    UFUNCTION(BlueprintCallable, Category = "Dungeon Generation")
+    const FDungeonLayout& GetLayout() const { return m_Layout; }
+
+    /** Stage times and counts of the current dungeon, spawning is only complete once its actors are spawned */
+    UFUNCTION(BlueprintPure, Category = "Dungeon Generation")
+    const FDungeonGenerationStats& GetLastGenerationStats() const { return m_Layout.Stats; }
+
+    UFUNCTION(BlueprintCallable, Category = "Dungeon Generation")
+    const TArray<ARoomBase*>& GetRooms() const { return m_Rooms; }
+
+    UFUNCTION(BlueprintCallable, Category = "Dungeon Generation")
+    const TArray<ACorridorBase*>& GetCorridors() const { return m_Corridors; }
+
+    /**
+     * Removes the current dungeon, its actors are kept hidden in the actor pool for the next generation
+     * Also stops a materialization or physics separation in progress
+     */
+    UFUNCTION(BlueprintCallable, Category = "Dungeon Generation")
+    void ClearDungeon();
+
+    /** Hits and misses of the actor pool since the subsystem was created */
+    UFUNCTION(BlueprintPure, Category = "Dungeon Generation")
+    FDungeonActorPoolStats GetActorPoolStats() const { return m_ActorPool ? m_ActorPool->GetStats() : FDungeonActorPoolStats(); }
+
+    /**
+     * Shows or hides a debug layer of the current dungeon without generating it again
+     * The triangulation and MST are only kept by dungeons generated with them drawn, and until the dungeon is edited live
+     * Does nothing in builds without debug drawing
+     * @param Layer - Layer to show or hide
+     * @param bVisible - Whether to draw the layer
+     */
+    UFUNCTION(BlueprintCallable, Category = "Dungeon Generation")
+    void SetDebugLayerVisible(EDungeonDebugLayer Layer, bool bVisible);
+
+    UFUNCTION(BlueprintPure, Category = "Dungeon Generation")
+    bool IsDebugLayerVisible(EDungeonDebugLayer Layer) const { return (m_DebugLayers & GetDebugLayerBit(Layer)) != 0; }
+
+    /** Actor holding the instanced corridors, null when corridors are spawned as actors */
+    UFUNCTION(BlueprintCallable, Category = "Dungeon Generation")
+    ADungeonCorridorInstances* GetCorridorInstances() { return m_CorridorInstances; }
+
+    // Settings
+
+    /** Separate rooms with the physics simulation instead of the deterministic separation solver */
+    UPROPERTY(BlueprintReadWrite, Category = "Dungeon Generation")
+    bool bUsePhysicsSeparation = false;
+
+    /** When the physics separation may stop before every room sleeps, it always stops after 5 s */
+    UPROPERTY(BlueprintReadWrite, Category = "Dungeon Generation")
+    EDungeonSettleCriterion SettleCriterion = EDungeonSettleCriterion::Sleep;
+
+    /** Speed under which rooms are settled with the ResidualSpeed criterion, in cm/s */
+    UPROPERTY(BlueprintReadWrite, Category = "Dungeon Generation")
+    float SettleMaxSpeed = 5.f;
+
+    /** Overlap depth under which rooms are settled with the OverlapDepth criterion, in cm */
+    UPROPERTY(BlueprintReadWrite, Category = "Dungeon Generation")
+    float SettleMaxOverlapDepth = 1.f;
+
+    /** Maximum number of iterations of the separation solver, remaining overlaps are removed afterwards */
+    UPROPERTY(BlueprintReadWrite, Category = "Dungeon Generation")
+    int32 SeparationMaxIterations = 1000;
+
+    /** Route corridors around the rooms on a grid instead of joining rooms with random L-shapes, rooms added live still get L-shapes */
+    UPROPERTY(BlueprintReadWrite, Category = "Dungeon Generation")
+    bool bRouteCorridors = false;
+
+    /** Cell size of the corridor routing grid, roughly the width of a corridor */
+    UPROPERTY(BlueprintReadWrite, Category = "Dungeon Generation")
+    float CorridorCellSize = 100.f;
+
+    /** Merge collinear corridor segments so shared stretches spawn one corridor, merged dungeons can't be edited live */
+    UPROPERTY(BlueprintReadWrite, Category = "Dungeon Generation")
+    bool bMergeCorridors = false;
+
+    /** Snap room centers to a fine grid before triangulating, so the triangulation and the MST use exact integer predicates */
+    UPROPERTY(BlueprintReadWrite, Category = "Dungeon Generation")
+    bool bSnapGeometryToGrid = false;
+
+    /** Time spent spawning actors per frame, GenerateDungeon spawns everything in one frame when zero */
+    UPROPERTY(BlueprintReadWrite, Category = "Dungeon Generation")
+    float MaterializeFrameBudgetMs = 0.f;
+
+    /** Spawn one actor per corridor segment or render corridor segments as instances */
+    UPROPERTY(BlueprintReadWrite, Category = "Dungeon Generation")
+    EDungeonCorridorMode CorridorMode = EDungeonCorridorMode::Actors;
+
+    /** GenerateDungeon streams rooms and corridors around the viewers instead of spawning the whole dungeon */
+    UPROPERTY(BlueprintReadWrite, Category = "Dungeon Generation")
+    bool bStreamActors = false;
+
+    /** Distance to a viewer under which streamed rooms and corridors are spawned */
+    UPROPERTY(BlueprintReadWrite, Category = "Dungeon Generation")
+    float StreamingRadius = 10000.f;
+
+    /** Extra distance before streamed actors are released, avoids spawning and releasing at the radius */
+    UPROPERTY(BlueprintReadWrite, Category = "Dungeon Generation")
+    float StreamingHysteresis = 2000.f;
+
+    /** Seconds between two streaming updates */
+    UPROPERTY(BlueprintReadWrite, Category = "Dungeon Generation")
+    float StreamingUpdateInterval = 0.2f;
+
+    /** Reuse hidden room and corridor actors of previous dungeons instead of destroying and spawning them */
+    UPROPERTY(BlueprintReadWrite, Category = "Dungeon Generation")
+    bool bUseActorPool = true;
+
+    /**
+     * Store generated layouts in Saved/DungeonCache and read them back for the same inputs, skipping the generation
+     * Ignored when drawing the triangulation or MST, which cached layouts do not keep
+     */
+    UPROPERTY(BlueprintReadWrite, Category = "Dungeon Generation")
+    bool bUseLayoutCache = true;
+
+    /** Whether the server replicates every room and corridor actor or only the layout, see EDungeonReplicationMode */
+    UPROPERTY(BlueprintReadWrite, Category = "Dungeon Generation")
+    EDungeonReplicationMode ReplicationMode = EDungeonReplicationMode::Actors;
+
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+    virtual void Deinitialize() override;
 
 private:
 
     // Core generation steps
-    TArray<ARoomBase*> CreateRooms(const TArray<TSubclassOf<ARoomBase>>& RoomClasses, const int& RoomNumber, const FVector& DungeonPosition, const FVector2D& DungeonBounds);
+    SDungeonLayoutParams MakeLayoutParams(int Seed, const TArray<TSubclassOf<ARoomBase>>& RoomClasses, int RoomNumber, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses, const FVector& DungeonPosition, const FVector2D& DungeonBounds) const;
+
+    bool LoadOrGenerateLayout(const SDungeonLayoutParams& Params, bool bUseCache, FDungeonLayout& OutLayout) const;
+
+    void SpawnLayout(const FDungeonLayout& Layout, const TArray<TSubclassOf<ARoomBase>>& RoomClasses, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses, const FVector& DefaultFocusPoint);
+
+    void CreateRooms(const FDungeonLayout& Layout, const TArray<TSubclassOf<ARoomBase>>& RoomClasses);
+
+    void CreateSimulatedRooms(TArray<int32>& ClassIndices, TConstArrayView<SRoomFootprint> Footprints);
 
     void OnAllRoomsSleep();
 
-    void RemoveOverlapedRooms(TArray<ARoomBase*>& Rooms);
-    
-    TArray<TPair<FVector2D, FVector2D>> GenerateCorridorLines(const TArray<TPair<FVector2D, FVector2D>>& MST);
+    void CreateCorridors(const FDungeonLayout& Layout, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses);
+
+    ARoomBase* SpawnRoom(const FDungeonLayout& Layout, int32 RoomIndex, const TArray<TSubclassOf<ARoomBase>>& RoomClasses);
+
+    ACorridorBase* SpawnCorridor(const FDungeonLayout& Layout, int32 CorridorIndex, const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses);
+
+    void CreateCorridorInstances(const TArray<TSubclassOf<ACorridorBase>>& CorridorClasses);
+
+    void AddCorridorInstances(const FDungeonLayout& Layout);
+
+    bool TickMaterialization(float DeltaTime);
 
-    void RemoveRoomsNotInCorridorLines(TArray<ARoomBase*>& Rooms, TArray<TPair<FVector2D, FVector2D>> CorridorLines);
+    void StopMaterialization();
+
+    bool TickStreaming(float DeltaTime);
+
+    void StopStreaming();
 
-    TArray<ACorridorBase*> CreateCorridors(TArray<TPair<FVector2D, FVector2D>> CorridorLines);
-    
     //Helper functions
-    TArray<FVector2D> GetPoints(const TArray<ARoomBase*>& Rooms);
+    static SRoomFootprint GetRoomFootprint(TSubclassOf<ARoomBase> RoomClass);
+
+    static SRoomFootprint GetRoomFootprint(const ARoomBase* Room);
+
+    static FTransform GetCorridorTransform(const FDungeonLayout& Layout, int32 CorridorIndex);
+
+    static uint8 GetDebugLayerBit(EDungeonDebugLayer Layer) { return static_cast<uint8>(1 << static_cast<int32>(Layer)); }
+
+    void DrawDebugLayout();
+
+    void DrawDebugLayer(EDungeonDebugLayer Layer);
+
+    void BuildDebugLines(EDungeonDebugLayer Layer, TArray<FBatchedLine>& OutLines) const;
+
+    void LogMaterializationCounts() const;
+
+    void LogGenerationStats() const;
+
+    void ReleaseRoom(ARoomBase* Room);
+
+    void ReleaseActor(AActor* Actor);
+
+    // Physics settle detection
+    void StartSettleDetection();
+
+    void StopSettleDetection();
+
+    UFUNCTION()
+    void OnRoomWake(UPrimitiveComponent* WakingComponent, FName BoneName);
+
+    UFUNCTION()
+    void OnRoomSleep(UPrimitiveComponent* SleepingComponent, FName BoneName);
+
+    bool TickSettle(float DeltaTime);
+
+    bool IsSettledEnough() const;
+
+    void FinishSettle();
 
-    void CheckAllRoomsSleeping();
+    // Replication
+    bool IsReplicatingLayout() const;
+
+    bool ShouldSpawnLocally(TSubclassOf<AActor> ActorClass) const;
+
+    void ApplyReplicationMode(AActor* Actor) const;
+
+    void PublishLayout();
+
+    static bool HasGameplayState(TSubclassOf<AActor> ActorClass);
+
+    // Live editing
+    bool CanEditLive() const;
+
+    bool BuildLiveGraph();
+
+    void ApplyTreeChanges(const TArray<SNodeEdge>& AddedEdges, const TArray<SNodeEdge>& RemovedEdges, int32& OutNumSpawned, int32& OutNumReleased);
+
+    void AddLiveRoom(const FTransform& Transform, int32 RoomClassIndex, int32 Node);
+
+    void RemoveLiveRoom(int32 RoomIndex);
+
+    void RemoveLiveCorridor(int32 CorridorIndex, TSet<int32>& OutDirtyInstanceClasses);
+
+    void FinishLiveEdit(const TCHAR* Operation, int32 NumAddedCorridors, int32 NumRemovedCorridors, double StartTime);
 
     // Data
+    FDungeonLayout m_Layout;
     TArray<ARoomBase*> m_Rooms;
+    TArray<TSubclassOf<ARoomBase>> m_RoomClasses;
     TArray<TSubclassOf<ACorridorBase>> m_CorridorClasses;
     TArray<ACorridorBase*> m_Corridors;
+    ADungeonCorridorInstances* m_CorridorInstances = nullptr;
+
+    // Physics separation state, kept until the rooms are sleeping
+    SDungeonLayoutParams m_LayoutParams;
+    FRandomStream m_RandomStream;
+    TArray<int32> m_RoomClassIndices;
+    // Layout generated on data or read from the cache before being spawned, kept so its arrays are reused
+    FDungeonLayout m_GeneratedLayout;
+    // Stats of the stages run before the rooms are sleeping
+    FDungeonGenerationStats m_PhysicsStats;
+    double m_GenerationStartTime = 0.0;
+    double m_PhysicsStartTime = 0.0;
+    // Cache entry receiving the layout once the rooms are sleeping
+    uint64 m_LayoutCacheKey = 0;
+    bool m_bSaveLayoutToCache = false;
+
+    // Generations running on worker threads, kept alive until complete
+    UPROPERTY()
+    TArray<TObjectPtr<UDungeonGenerationHandle>> m_AsyncGenerations;
+
+    UPROPERTY()
+    TObjectPtr<UDungeonActorPool> m_ActorPool;
+
+    // Server side actor replicating the layout, spawned the first time a layout is published
+    UPROPERTY()
+    TObjectPtr<ADungeonReplicator> m_Replicator;
+
+    // Time sliced materialization state
+    TArray<SMaterializeItem> m_MaterializeQueue;
+    int32 m_MaterializeNext = 0;
+    FTSTicker::FDelegateHandle m_MaterializeTicker;
+
+    // Streaming state, m_Rooms and m_Corridors hold the streamed in actors in the order of the streamed in indices
+    TArray<TWeakObjectPtr<AActor>> m_StreamingViewers;
+    TArray<FBox2D> m_StreamRoomBounds;
+    SRoomGrid m_StreamRoomGrid;
+    // Layout index of each corridor spawned as an actor, the corridor grid and bounds use the same order
+    TArray<int32> m_StreamCorridorLayoutIndices;
+    TArray<FBox2D> m_StreamCorridorBounds;
+    SRoomGrid m_StreamCorridorGrid;
+    TArray<int32> m_StreamedRoomIndices;
+    TArray<int32> m_StreamedCorridorIndices;
+    TBitArray<> m_IsRoomStreamedIn;
+    TBitArray<> m_IsCorridorStreamedIn;
+    FTSTicker::FDelegateHandle m_StreamingTicker;
+
+    // Materialized dungeon, layout index of each entry of m_Rooms and m_Corridors
+    TArray<int32> m_RoomLayoutIndices;
+    TArray<int32> m_CorridorLayoutIndices;
+
+    // Live editing state, built by the first room added or removed, and the inverse of the arrays above
+    SDungeonLiveGraph m_LiveGraph;
+    FRandomStream m_LiveStream;
+    // Live graph node of each layout room, INDEX_NONE for rooms only kept because a corridor goes through them
+    TArray<int32> m_RoomNodes;
+    // Layout room of each live graph node
+    TArray<int32> m_NodeRooms;
+    // Layout corridors of each tree edge, and tree edge of each layout corridor
+    TMap<uint64, TArray<int32, TInlineAllocator<2>>> m_EdgeCorridors;
+    TArray<uint64> m_CorridorEdges;
+    // Index in m_Rooms and m_Corridors of each layout room and corridor, INDEX_NONE when not spawned as an actor
+    TArray<int32> m_RoomSlots;
+    TArray<int32> m_CorridorSlots;
 
-    FTimerHandle SleepCheckHandle;
+    // Physics settle state, room index of each simulated body and whether the body of each entry of m_Rooms is awake
+    TMap<const UPrimitiveComponent*, int32> m_SettleRoomIndices;
+    TBitArray<> m_IsRoomAwake;
+    std::atomic<int32> m_NumAwakeRooms{ 0 };
+    FTSTicker::FDelegateHandle m_SettleTicker;
+    FTimerHandle SettledHandle;
     FTimerHandle SafetyHandle;
 
-    float DungeonHeight;
+    // Debug, one bit per visible EDungeonDebugLayer
+    uint8 m_DebugLayers = 0;
+    FBox m_DebugBounds = FBox(ForceInit);
 
-    // Debug
-    bool m_DrawTriangulation;
-    bool m_DrawMST;
-    bool m_DrawCorridorLines;
-};
\ No newline at end of file
+    UPROPERTY()
+    TObjectPtr<ADungeonDebugDraw> m_DebugDraw;
+};
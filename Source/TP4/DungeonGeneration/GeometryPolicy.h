@@ -0,0 +1,184 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Scalar type the triangulation and the MST compute with
+ */
+enum class EGeometryPrecision : uint8
+{
+    // Single precision, fastest but the sign of nearly degenerate predicates can be wrong
+    Float,
+    // Double precision, the default
+    Double,
+    // Points snapped to a fixed point grid, every predicate is exact
+    Fixed
+};
+
+/**
+ * Signed 128 bit integer, only what the exact in-circle test needs
+ */
+struct SInt128
+{
+public:
+    uint64 Low = 0;
+    int64 High = 0;
+
+    // Full product of two 64 bit integers
+    static SInt128 Multiply(int64 A, int64 B)
+    {
+        const uint64 UA = A < 0 ? 0 - static_cast<uint64>(A) : static_cast<uint64>(A);
+        const uint64 UB = B < 0 ? 0 - static_cast<uint64>(B) : static_cast<uint64>(B);
+
+        // Schoolbook product of the 32 bit halves
+        const uint64 P00 = (UA & 0xFFFFFFFFull) * (UB & 0xFFFFFFFFull);
+        const uint64 P01 = (UA & 0xFFFFFFFFull) * (UB >> 32);
+        const uint64 P10 = (UA >> 32) * (UB & 0xFFFFFFFFull);
+        const uint64 P11 = (UA >> 32) * (UB >> 32);
+        const uint64 Middle = (P00 >> 32) + (P01 & 0xFFFFFFFFull) + (P10 & 0xFFFFFFFFull);
+
+        uint64 ResultLow = (Middle << 32) | (P00 & 0xFFFFFFFFull);
+        uint64 ResultHigh = P11 + (P01 >> 32) + (P10 >> 32) + (Middle >> 32);
+
+        // Two's complement negation when the signs differ
+        if ((A < 0) != (B < 0))
+        {
+            ResultLow = ~ResultLow + 1;
+            ResultHigh = ~ResultHigh + (ResultLow == 0 ? 1 : 0);
+        }
+
+        SInt128 Result;
+        Result.Low = ResultLow;
+        Result.High = static_cast<int64>(ResultHigh);
+        return Result;
+    }
+
+    SInt128 operator+(const SInt128& Other) const
+    {
+        SInt128 Result;
+        Result.Low = Low + Other.Low;
+        Result.High = static_cast<int64>(static_cast<uint64>(High) + static_cast<uint64>(Other.High) + (Result.Low < Low ? 1 : 0));
+        return Result;
+    }
+
+    int32 Sign() const
+    {
+        return High < 0 ? -1 : ((High | static_cast<int64>(Low != 0)) != 0 ? 1 : 0);
+    }
+};
+
+/**
+ * Geometry on floating point coordinates
+ * The predicates are plain determinants, relative to one of the points to keep the magnitudes small
+ */
+template<typename InScalarType, typename InPointType>
+struct TFloatingGeometry
+{
+public:
+    using ScalarType = InScalarType;
+    using PointType = InPointType;
+    using DistanceType = InScalarType;
+
+    static constexpr bool bExact = false;
+
+    static PointType FromWorld(const FVector2D& Point) { return PointType(Point); }
+
+    // Twice the signed area of A, B, C, positive when they are counter-clockwise
+    static ScalarType Orient(const PointType& A, const PointType& B, const PointType& C)
+    {
+        return (B.X - A.X) * (C.Y - A.Y) - (B.Y - A.Y) * (C.X - A.X);
+    }
+
+    // Positive when D lies inside the circumcircle of the counter-clockwise triangle A, B, C
+    static ScalarType InCircle(const PointType& A, const PointType& B, const PointType& C, const PointType& D)
+    {
+        const ScalarType ADX = A.X - D.X, ADY = A.Y - D.Y;
+        const ScalarType BDX = B.X - D.X, BDY = B.Y - D.Y;
+        const ScalarType CDX = C.X - D.X, CDY = C.Y - D.Y;
+
+        const ScalarType ALift = ADX * ADX + ADY * ADY;
+        const ScalarType BLift = BDX * BDX + BDY * BDY;
+        const ScalarType CLift = CDX * CDX + CDY * CDY;
+
+        return ALift * (BDX * CDY - CDX * BDY)
+            + BLift * (CDX * ADY - ADX * CDY)
+            + CLift * (ADX * BDY - BDX * ADY);
+    }
+
+    static int32 OrientSign(const PointType& A, const PointType& B, const PointType& C)
+    {
+        const ScalarType Det = Orient(A, B, C);
+        return (Det > 0) - (Det < 0);
+    }
+
+    static int32 InCircleSign(const PointType& A, const PointType& B, const PointType& C, const PointType& D)
+    {
+        const ScalarType Det = InCircle(A, B, C, D);
+        return (Det > 0) - (Det < 0);
+    }
+
+    static DistanceType DistanceSquared(const PointType& A, const PointType& B)
+    {
+        return (B.X - A.X) * (B.X - A.X) + (B.Y - A.Y) * (B.Y - A.Y);
+    }
+};
+
+using SFloatGeometry = TFloatingGeometry<float, FVector2f>;
+using SDoubleGeometry = TFloatingGeometry<double, FVector2D>;
+
+/**
+ * Geometry on a fixed point grid of Resolution world units, coordinates being int64 cells
+ * Coordinates are kept within MaxCoordinate cells, so differences fit 30 bits: orientations and distances are
+ * exact in 64 bits and the in-circle determinant is exact in 128 bits
+ * Points closer than a cell are snapped to the same cell and triangulated as duplicates
+ */
+struct SFixedGeometry
+{
+public:
+    using ScalarType = int64;
+    using PointType = FInt64Point;
+    using DistanceType = int64;
+
+    static constexpr bool bExact = true;
+
+    // Size of a cell in world units
+    static constexpr double Resolution = 1.0 / 16.0;
+
+    // Largest coordinate in cells, the super-triangle included, about 330 km
+    static constexpr int64 MaxCoordinate = int64(1) << 29;
+
+    // Coordinates beyond the grid are clamped, predicates on them are then exact for the clamped points only
+    static PointType FromWorld(const FVector2D& Point)
+    {
+        return PointType(
+            FMath::Clamp(FMath::RoundToInt64(Point.X / Resolution), -MaxCoordinate, MaxCoordinate),
+            FMath::Clamp(FMath::RoundToInt64(Point.Y / Resolution), -MaxCoordinate, MaxCoordinate));
+    }
+
+    static int32 OrientSign(const PointType& A, const PointType& B, const PointType& C)
+    {
+        const int64 Det = (B.X - A.X) * (C.Y - A.Y) - (B.Y - A.Y) * (C.X - A.X);
+        return (Det > 0) - (Det < 0);
+    }
+
+    static int32 InCircleSign(const PointType& A, const PointType& B, const PointType& C, const PointType& D)
+    {
+        const int64 ADX = A.X - D.X, ADY = A.Y - D.Y;
+        const int64 BDX = B.X - D.X, BDY = B.Y - D.Y;
+        const int64 CDX = C.X - D.X, CDY = C.Y - D.Y;
+
+        // Lifts and minors stay below 2^62, only their products need 128 bits
+        const int64 ALift = ADX * ADX + ADY * ADY;
+        const int64 BLift = BDX * BDX + BDY * BDY;
+        const int64 CLift = CDX * CDX + CDY * CDY;
+
+        return (SInt128::Multiply(ALift, BDX * CDY - CDX * BDY)
+            + SInt128::Multiply(BLift, CDX * ADY - ADX * CDY)
+            + SInt128::Multiply(CLift, ADX * BDY - BDX * ADY)).Sign();
+    }
+
+    static DistanceType DistanceSquared(const PointType& A, const PointType& B)
+    {
+        return (B.X - A.X) * (B.X - A.X) + (B.Y - A.Y) * (B.Y - A.Y);
+    }
+};
@@ -1,112 +1,230 @@
 #include "MinSpanTree.h"
+#include "DungeonStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("MST Kruskal"), STAT_DungeonMSTKruskal, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("MST Prim"), STAT_DungeonMSTPrim, STATGROUP_Dungeon);
+
+/**
+ * Generates Minimum Spanning Tree of a triangulation
+ * @param Mesh - Input Delaunay triangulation, each edge being stored once
+ * @param OutMST - Receives the mesh edge indices forming the MST
+ * @param Algorithm - Kruskal (sort + union-find) or Prim (binary heap)
+ * @param Precision - Scalar type of the edge lengths
+ */
+void UMinSpanTree::GenerateMST(const SDungeonMesh& Mesh, TArray<int32>& OutMST, EMSTAlgorithm Algorithm, EGeometryPrecision Precision)
+{
+    // A spanning tree has one edge less than the number of points
+    OutMST.Reset(Mesh.Vertices.Num());
+
+    switch (Precision)
+    {
+    case EGeometryPrecision::Float:
+        GenerateMST<SFloatGeometry>(Mesh, OutMST, Algorithm);
+        break;
+    case EGeometryPrecision::Fixed:
+        GenerateMST<SFixedGeometry>(Mesh, OutMST, Algorithm);
+        break;
+    case EGeometryPrecision::Double:
+    default:
+        GenerateMST<SDoubleGeometry>(Mesh, OutMST, Algorithm);
+        break;
+    }
+}
+
+template<typename PolicyType>
+void UMinSpanTree::GenerateMST(const SDungeonMesh& Mesh, TArray<int32>& OutMST, EMSTAlgorithm Algorithm)
+{
+    switch (Algorithm)
+    {
+    case EMSTAlgorithm::Prim:
+        GeneratePrim<PolicyType>(Mesh, OutMST);
+        break;
+    case EMSTAlgorithm::Kruskal:
+    default:
+        GenerateKruskal<PolicyType>(Mesh, OutMST);
+        break;
+    }
+}
 
 /**
- * Generates Minimum Spanning Tree using Kruskal's algorithm
- * @param Triangulation - Input Delaunay triangulation
- * @return Array of edges forming the MST
+ * Kruskal's algorithm
+ * Edges are sorted once by length and accepted when they join two different trees of the forest
  */
-TArray<TPair<FVector2D, FVector2D>> UMinSpanTree::GenerateMST(const TArray<STriangle>& Triangulation)
+template<typename PolicyType>
+void UMinSpanTree::GenerateKruskal(const SDungeonMesh& Mesh, TArray<int32>& OutMST)
 {
-    // Extract unique points from triangulation
-    TArray<FVector2D> Points = GetPointsOfTriangles(Triangulation);
+    DUNGEON_SCOPE(STAT_DungeonMSTKruskal);
 
-    // Create edges with their lengths
-    TArray<TPair<float, TPair<FVector2D, FVector2D>>> Edges;
+    using SEdgeKey = TPair<typename PolicyType::DistanceType, int32>;
 
-    for (const STriangle& Triangle : Triangulation)
+    FMemMark Mark(FMemStack::Get());
+
+    const int32 NumEdges = Mesh.NumEdges();
+
+    // Sort edges by length, ties broken by index to keep the result deterministic
+    TDungeonScratchArray<SEdgeKey> Edges;
+    Edges.Reserve(NumEdges);
+    for (int32 EdgeIndex = 0; EdgeIndex < NumEdges; EdgeIndex++)
     {
-        // Add all edges from triangle with their lengths
-        Edges.Add(TPair<float, TPair<FVector2D, FVector2D>>(FVector2D::Distance(Triangle.A, Triangle.B),
-                                                            TPair<FVector2D, FVector2D>(Triangle.A, Triangle.B)));
-        Edges.Add(TPair<float, TPair<FVector2D, FVector2D>>(FVector2D::Distance(Triangle.B, Triangle.C),
-                                                            TPair<FVector2D, FVector2D>(Triangle.B, Triangle.C)));
-        Edges.Add(TPair<float, TPair<FVector2D, FVector2D>>(FVector2D::Distance(Triangle.C, Triangle.A),
-                                                            TPair<FVector2D, FVector2D>(Triangle.C, Triangle.A)));
+        Edges.Add(SEdgeKey(GetEdgeLengthSquared<PolicyType>(Mesh, EdgeIndex), EdgeIndex));
     }
 
-    // Sort edges by length (critical for Kruskal's algorithm)
-    Edges.Sort([](const TPair<float, TPair<FVector2D, FVector2D>>& A, const TPair<float, TPair<FVector2D, FVector2D>>& B)
+    Edges.Sort([](const SEdgeKey& A, const SEdgeKey& B)
     {
-        return A.Key < B.Key;
+        return A.Key < B.Key || (A.Key == B.Key && A.Value < B.Value);
     });
 
-    // Remove duplicate edges (same edge from different triangles)
-    for (int i = Edges.Num() - 1; i >= 0; --i)
+    TDisjointSet<TMemStackAllocator<>> Forest;
+    Forest.Initialize(Mesh.Vertices.Num());
+
+    for (const SEdgeKey& Edge : Edges)
     {
-        for (int j = i - 1; j >= 0; --j)
+        // Only keep edges joining two different trees
+        if (Forest.Union(Mesh.GetEdgeStartIndex(Edge.Value), Mesh.GetEdgeEndIndex(Edge.Value)))
         {
-            if ((Edges[i].Value.Key   == Edges[j].Value.Key &&
-                 Edges[i].Value.Value == Edges[j].Value.Value) ||
-                (Edges[i].Value.Key   == Edges[j].Value.Value &&
-                 Edges[i].Value.Value == Edges[j].Value.Key))
+            OutMST.Add(Edge.Value);
+
+            // A spanning tree has one edge less than the number of points
+            if (OutMST.Num() == Mesh.Vertices.Num() - 1)
             {
-                Edges.RemoveAt(i);
                 break;
             }
         }
     }
+}
+
+/**
+ * Prim's algorithm
+ * Grows the tree from a vertex, always adding the shortest edge leaving it, using a binary heap of candidate edges
+ */
+template<typename PolicyType>
+void UMinSpanTree::GeneratePrim(const SDungeonMesh& Mesh, TArray<int32>& OutMST)
+{
+    DUNGEON_SCOPE(STAT_DungeonMSTPrim);
+
+    using SEdgeKey = TPair<typename PolicyType::DistanceType, int32>;
+
+    FMemMark Mark(FMemStack::Get());
 
-    // Build MST using Kruskal's algorithm
-    TArray<TPair<FVector2D, FVector2D>> MST;
-    TArray<FVector2D> ConnectedPoints;
+    const int32 NumVertices = Mesh.Vertices.Num();
+    const int32 NumEdges = Mesh.NumEdges();
+
+    // Build vertex to edge adjacency in compressed rows
+    TDungeonScratchArray<int32> AdjacencyOffsets;
+    AdjacencyOffsets.Init(0, NumVertices + 1);
+    for (int32 VertexIndex : Mesh.Edges)
+    {
+        AdjacencyOffsets[VertexIndex + 1]++;
+    }
+    for (int32 VertexIndex = 0; VertexIndex < NumVertices; VertexIndex++)
+    {
+        AdjacencyOffsets[VertexIndex + 1] += AdjacencyOffsets[VertexIndex];
+    }
 
-    // Start with first point
-    if (Points.Num() > 0)
+    TDungeonScratchArray<int32> AdjacentEdges;
+    AdjacentEdges.SetNumUninitialized(NumEdges * 2);
+    TDungeonScratchArray<int32> FillOffsets(AdjacencyOffsets);
+    for (int32 EdgeIndex = 0; EdgeIndex < NumEdges; EdgeIndex++)
     {
-        ConnectedPoints.Add(Points[0]);
+        AdjacentEdges[FillOffsets[Mesh.GetEdgeStartIndex(EdgeIndex)]++] = EdgeIndex;
+        AdjacentEdges[FillOffsets[Mesh.GetEdgeEndIndex(EdgeIndex)]++] = EdgeIndex;
     }
 
-    // Add edges until all points are connecte
-    while (ConnectedPoints.Num() < Points.Num())
+    TBitArray<TMemStackAllocator<>> ConnectedPoints(false, NumVertices);
+
+    // Candidate edges, stale entries are skipped when popped
+    TDungeonScratchArray<SEdgeKey> Heap;
+    Heap.Reserve(NumEdges);
+    auto HeapPredicate = [](const SEdgeKey& A, const SEdgeKey& B)
     {
-        float BestDistance = FLT_MAX;
-        TPair<FVector2D, FVector2D> BestEdge;
-        bool EdgeFound = false;
+        return A.Key < B.Key || (A.Key == B.Key && A.Value < B.Value);
+    };
 
-        // Find shortest edge that connects a new point
-        for (const auto& Edge : Edges)
+    auto ConnectPoint = [&](int32 VertexIndex)
+    {
+        ConnectedPoints[VertexIndex] = true;
+        for (int32 i = AdjacencyOffsets[VertexIndex]; i < AdjacencyOffsets[VertexIndex + 1]; i++)
         {
-            bool AConnected = ConnectedPoints.Contains(Edge.Value.Key);
-            bool BConnected = ConnectedPoints.Contains(Edge.Value.Value);
-
-            // Edge must connect one connected and one unconnected point
-            if (AConnected ^ BConnected)
+            const int32 EdgeIndex = AdjacentEdges[i];
+            const int32 Other = Mesh.GetEdgeStartIndex(EdgeIndex) == VertexIndex ? Mesh.GetEdgeEndIndex(EdgeIndex) : Mesh.GetEdgeStartIndex(EdgeIndex);
+            if (!ConnectedPoints[Other])
             {
-                if (Edge.Key < BestDistance)
-                {
-                    BestDistance = Edge.Key;
-                    BestEdge = Edge.Value;
-                    EdgeFound = true;
-                }
+                Heap.HeapPush(SEdgeKey(GetEdgeLengthSquared<PolicyType>(Mesh, EdgeIndex), EdgeIndex), HeapPredicate);
             }
         }
+    };
 
-        // Add best edge to MST
-        if (EdgeFound)
+    // Restart from every unconnected vertex so disconnected meshes give a forest, like Kruskal
+    for (int32 StartIndex = 0; StartIndex < NumVertices; StartIndex++)
+    {
+        if (ConnectedPoints[StartIndex] || AdjacencyOffsets[StartIndex] == AdjacencyOffsets[StartIndex + 1])
         {
-            MST.Add(BestEdge);
-            ConnectedPoints.AddUnique(BestEdge.Key);
-            ConnectedPoints.AddUnique(BestEdge.Value);
+            continue;
         }
-        else
+
+        ConnectPoint(StartIndex);
+
+        while (Heap.Num() > 0)
         {
-            break; // No more valid edges found
+            SEdgeKey Edge;
+            Heap.HeapPop(Edge, HeapPredicate, EAllowShrinking::No);
+
+            const bool AConnected = ConnectedPoints[Mesh.GetEdgeStartIndex(Edge.Value)];
+            const bool BConnected = ConnectedPoints[Mesh.GetEdgeEndIndex(Edge.Value)];
+
+            // Edge must connect one connected and one unconnected point
+            if (AConnected ^ BConnected)
+            {
+                OutMST.Add(Edge.Value);
+                ConnectPoint(AConnected ? Mesh.GetEdgeEndIndex(Edge.Value) : Mesh.GetEdgeStartIndex(Edge.Value));
+            }
         }
     }
+}
+
+template<typename AllocatorType>
+void TDisjointSet<AllocatorType>::Initialize(int32 NumElements)
+{
+    Parents.SetNumUninitialized(NumElements);
+    Sizes.Init(1, NumElements);
+    for (int32 i = 0; i < NumElements; i++)
+    {
+        Parents[i] = i;
+    }
+}
 
-    return MST;
+template<typename AllocatorType>
+int32 TDisjointSet<AllocatorType>::Find(int32 Element)
+{
+    // Path halving: every visited node is linked to its grandparent
+    while (Parents[Element] != Element)
+    {
+        Parents[Element] = Parents[Parents[Element]];
+        Element = Parents[Element];
+    }
+    return Element;
 }
 
-TArray<FVector2D> UMinSpanTree::GetPointsOfTriangles(const TArray<STriangle>& Triangles)
+template<typename AllocatorType>
+bool TDisjointSet<AllocatorType>::Union(int32 A, int32 B)
 {
-    TArray<FVector2D> Points;
+    int32 RootA = Find(A);
+    int32 RootB = Find(B);
 
-    for (const STriangle& Triangle : Triangles)
+    if (RootA == RootB)
     {
-        Points.AddUnique(Triangle.A);
-        Points.AddUnique(Triangle.B);
-        Points.AddUnique(Triangle.C);
+        return false;
     }
 
-    return Points;
+    // Attach the smaller tree below the larger one
+    if (Sizes[RootA] < Sizes[RootB])
+    {
+        Swap(RootA, RootB);
+    }
+    Parents[RootB] = RootA;
+    Sizes[RootA] += Sizes[RootB];
+    return true;
 }
+
+template struct TDisjointSet<FDefaultAllocator>;
+template struct TDisjointSet<TMemStackAllocator<>>;
@@ -2,9 +2,42 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
-#include "Triangulation.h"
+#include "DungeonMesh.h"
+#include "DungeonScratch.h"
+#include "GeometryPolicy.h"
 #include "MinSpanTree.generated.h"
 
+/**
+ * Algorithm used to build the minimum spanning tree
+ * Both give the same tree, Kruskal sorts every edge once while Prim grows the tree from a binary heap
+ */
+enum class EMSTAlgorithm : uint8
+{
+    Kruskal,
+    Prim
+};
+
+/**
+ * Disjoint-set forest with path compression and union by size
+ * The MST keeps its forest on the memory stack, AllocatorType selects where the buffers live
+ */
+template<typename AllocatorType = FDefaultAllocator>
+struct TDisjointSet
+{
+public:
+    TArray<int32, AllocatorType> Parents;
+    TArray<int32, AllocatorType> Sizes;
+
+    void Initialize(int32 NumElements);
+
+    int32 Find(int32 Element);
+
+    // Merges the sets of both elements, returns false if they were already in the same set
+    bool Union(int32 A, int32 B);
+};
+
+using SDisjointSet = TDisjointSet<>;
+
 UCLASS()
 class TP4_API UMinSpanTree : public UObject
 {
@@ -12,11 +45,28 @@ class TP4_API UMinSpanTree : public UObject
 
 public:
 
-    static TArray<TPair<FVector2D, FVector2D>> GenerateMST(const TArray<STriangle>& Triangulation);
+    // Fills OutMST with the indices of the mesh edges forming the MST, reusing its allocation
+    // Precision selects how edge lengths are compared, Fixed comparing exact squared lengths on the fixed point grid
+    static void GenerateMST(const SDungeonMesh& Mesh, TArray<int32>& OutMST, EMSTAlgorithm Algorithm = EMSTAlgorithm::Kruskal, EGeometryPrecision Precision = EGeometryPrecision::Double);
 
 private:
 
-    static TArray<FVector2D> GetPointsOfTriangles(const TArray<STriangle>& Triangles);
+    template<typename PolicyType>
+    static void GenerateMST(const SDungeonMesh& Mesh, TArray<int32>& OutMST, EMSTAlgorithm Algorithm);
+
+    template<typename PolicyType>
+    static void GenerateKruskal(const SDungeonMesh& Mesh, TArray<int32>& OutMST);
+
+    template<typename PolicyType>
+    static void GeneratePrim(const SDungeonMesh& Mesh, TArray<int32>& OutMST);
+
+    template<typename PolicyType>
+    static typename PolicyType::DistanceType GetEdgeLengthSquared(const SDungeonMesh& Mesh, int32 EdgeIndex)
+    {
+        return PolicyType::DistanceSquared(
+            PolicyType::FromWorld(Mesh.Vertices[Mesh.GetEdgeStartIndex(EdgeIndex)]),
+            PolicyType::FromWorld(Mesh.Vertices[Mesh.GetEdgeEndIndex(EdgeIndex)]));
+    }
 
 };
 
@@ -17,6 +17,9 @@ ARoomBase::ARoomBase()
     RoomExtent->BodyInstance.bLockZRotation = true;
     RoomExtent->SetCollisionProfileName(FName("PhysicsActor"), true);
     RoomExtent->SetUseCCD(true);
+    RoomExtent->BodyInstance.bGenerateWakeEvents = true;
+
+    bHasGameplayState = false;
 
     SetTickGroup(ETickingGroup::TG_PrePhysics);
 	PrimaryActorTick.bCanEverTick = true;
@@ -31,3 +34,13 @@ void ARoomBase::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 }
+
+void ARoomBase::OnReleasedToPool_Implementation()
+{
+	RoomExtent->SetPhysicsLinearVelocity(FVector::ZeroVector);
+	RoomExtent->SetPhysicsAngularVelocityInDegrees(FVector::ZeroVector);
+}
+
+void ARoomBase::OnAcquiredFromPool_Implementation()
+{
+}
@@ -4,10 +4,11 @@
 #include "GameFramework/Actor.h"
 #include "Components/BoxComponent.h"
 #include "PhysicsEngine/PhysicsConstraintComponent.h"
+#include "DungeonActorPool.h"
 #include "RoomBase.generated.h"
 
 UCLASS()
-class TP4_API ARoomBase : public AActor
+class TP4_API ARoomBase : public AActor, public IDungeonPooledActor
 {
 	GENERATED_BODY()
 	
@@ -18,7 +19,16 @@ public:
 
 	virtual void Tick(float DeltaTime) override;
 
+	// Stops the room from moving while it waits in the pool, subclasses clear their gameplay state too
+	virtual void OnReleasedToPool_Implementation() override;
+
+	virtual void OnAcquiredFromPool_Implementation() override;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	UBoxComponent* RoomExtent;
 
+	// Rooms with gameplay state stay replicated actors when the layout is replicated, clients never spawn them locally
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Dungeon Generation")
+	bool bHasGameplayState;
+
 };
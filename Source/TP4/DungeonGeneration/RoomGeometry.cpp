@@ -0,0 +1,159 @@
+#include "RoomGeometry.h"
+
+/**
+ * Separating axis test between two oriented boxes
+ * In 2D the only candidate axes are the two local axes of each box
+ */
+bool SRoomFootprint::Overlaps(const SRoomFootprint& Other, double Tolerance) const
+{
+    const FVector2D Axes[4] = {
+        FVector2D(1.0, 0.0).GetRotated(Yaw),
+        FVector2D(0.0, 1.0).GetRotated(Yaw),
+        FVector2D(1.0, 0.0).GetRotated(Other.Yaw),
+        FVector2D(0.0, 1.0).GetRotated(Other.Yaw)
+    };
+
+    const FVector2D Delta = Other.GetCenter() - GetCenter();
+
+    for (const FVector2D& Axis : Axes)
+    {
+        // Projected half sizes of both boxes on the axis
+        const double Radius = Extent.X * FMath::Abs(Axes[0] | Axis) + Extent.Y * FMath::Abs(Axes[1] | Axis);
+        const double OtherRadius = Other.Extent.X * FMath::Abs(Axes[2] | Axis) + Other.Extent.Y * FMath::Abs(Axes[3] | Axis);
+
+        if (FMath::Abs(Delta | Axis) >= Radius + OtherRadius - Tolerance)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Slab test between a segment and the oriented box
+ * The segment is moved to the box local space, where the box is axis aligned
+ */
+bool SRoomFootprint::IntersectsSegment(const FVector2D& Start, const FVector2D& End) const
+{
+    const FVector2D Center = GetCenter();
+    const FVector2D LocalStart = (Start - Center).GetRotated(-Yaw);
+    const FVector2D Direction = (End - Center).GetRotated(-Yaw) - LocalStart;
+
+    double MinTime = 0.0;
+    double MaxTime = 1.0;
+
+    for (int32 Axis = 0; Axis < 2; Axis++)
+    {
+        // Segment parallel to the slab, it has to start inside it
+        if (FMath::Abs(Direction[Axis]) < UE_DOUBLE_SMALL_NUMBER)
+        {
+            if (FMath::Abs(LocalStart[Axis]) > Extent[Axis])
+            {
+                return false;
+            }
+            continue;
+        }
+
+        double EnterTime = (-Extent[Axis] - LocalStart[Axis]) / Direction[Axis];
+        double ExitTime = (Extent[Axis] - LocalStart[Axis]) / Direction[Axis];
+        if (EnterTime > ExitTime)
+        {
+            Swap(EnterTime, ExitTime);
+        }
+
+        MinTime = FMath::Max(MinTime, EnterTime);
+        MaxTime = FMath::Min(MaxTime, ExitTime);
+        if (MinTime > MaxTime)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Builds the cell lists with a counting sort
+ * The cell starts are used as fill cursors and shifted back afterwards, so rebuilding a grid allocates nothing once its lists are large enough
+ * @param Boxes - Boxes to register, their index is the item returned by queries
+ * @param InCellSize - Requested cell size, usually the size of the largest box
+ */
+template<typename AllocatorType>
+void TRoomGrid<AllocatorType>::Build(TConstArrayView<FBox2D> Boxes, double InCellSize)
+{
+    CellStarts.Reset();
+    CellItems.Reset();
+    NumCellsX = 0;
+    NumCellsY = 0;
+
+    if (Boxes.Num() == 0)
+    {
+        return;
+    }
+
+    FBox2D Bounds(ForceInit);
+    for (const FBox2D& Box : Boxes)
+    {
+        Bounds += Box;
+    }
+
+    // Keep at most a few cells per box so sparse layouts don't allocate huge grids
+    const FVector2D Size = Bounds.GetSize();
+    const double MaxCells = FMath::Max(16.0, 4.0 * Boxes.Num());
+    CellSize = FMath::Max(InCellSize, UE_DOUBLE_KINDA_SMALL_NUMBER);
+    if ((Size.X / CellSize + 1.0) * (Size.Y / CellSize + 1.0) > MaxCells)
+    {
+        CellSize = FMath::Max(CellSize, FMath::Sqrt(Size.X * Size.Y / MaxCells) + 1.0);
+        CellSize = FMath::Max(CellSize, FMath::Max(Size.X, Size.Y) / MaxCells + 1.0);
+    }
+
+    Origin = Bounds.Min;
+    NumCellsX = FMath::FloorToInt32(Size.X / CellSize) + 1;
+    NumCellsY = FMath::FloorToInt32(Size.Y / CellSize) + 1;
+
+    // Count items per cell, the count of cell i being stored at i + 1
+    CellStarts.Init(0, NumCellsX * NumCellsY + 1);
+    for (const FBox2D& Box : Boxes)
+    {
+        const FIntPoint MinCell = GetCell(Box.Min);
+        const FIntPoint MaxCell = GetCell(Box.Max);
+        for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+        {
+            for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+            {
+                CellStarts[Y * NumCellsX + X + 1]++;
+            }
+        }
+    }
+
+    for (int32 Cell = 0; Cell < NumCellsX * NumCellsY; Cell++)
+    {
+        CellStarts[Cell + 1] += CellStarts[Cell];
+    }
+
+    // Fill cells, items end up sorted by index inside each cell
+    // Filling cell i moves CellStarts[i] to the start of cell i + 1
+    CellItems.SetNumUninitialized(CellStarts.Last());
+    for (int32 BoxIndex = 0; BoxIndex < Boxes.Num(); BoxIndex++)
+    {
+        const FIntPoint MinCell = GetCell(Boxes[BoxIndex].Min);
+        const FIntPoint MaxCell = GetCell(Boxes[BoxIndex].Max);
+        for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+        {
+            for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+            {
+                CellItems[CellStarts[Y * NumCellsX + X]++] = BoxIndex;
+            }
+        }
+    }
+
+    for (int32 Cell = NumCellsX * NumCellsY; Cell > 0; Cell--)
+    {
+        CellStarts[Cell] = CellStarts[Cell - 1];
+    }
+    CellStarts[0] = 0;
+}
+
+template struct TRoomGrid<FDefaultAllocator>;
+template struct TRoomGrid<TMemStackAllocator<>>;
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonScratch.h"
+
+/**
+ * 2D footprint of a room, read from its RoomExtent box
+ * Location is the actor location, Offset and Extent are expressed in the room local space
+ */
+struct SRoomFootprint
+{
+public:
+    FVector2D Location = FVector2D::ZeroVector;
+    FVector2D Offset = FVector2D::ZeroVector;
+    FVector2D Extent = FVector2D::ZeroVector;
+    float Yaw = 0.f;
+
+    // World space center of the box
+    FVector2D GetCenter() const { return Location + Offset.GetRotated(Yaw); }
+
+    // World space half size of the axis aligned bounds, exact for quarter turns
+    FVector2D GetAxisAlignedExtent() const
+    {
+        const double Cos = FMath::Abs(FMath::Cos(FMath::DegreesToRadians(Yaw)));
+        const double Sin = FMath::Abs(FMath::Sin(FMath::DegreesToRadians(Yaw)));
+        return FVector2D(Cos * Extent.X + Sin * Extent.Y, Sin * Extent.X + Cos * Extent.Y);
+    }
+
+    FBox2D GetBounds() const
+    {
+        const FVector2D Center = GetCenter();
+        const FVector2D HalfSize = GetAxisAlignedExtent();
+        return FBox2D(Center - HalfSize, Center + HalfSize);
+    }
+
+    // Exact oriented box test, boxes touching within Tolerance are not considered overlapping
+    bool Overlaps(const SRoomFootprint& Other, double Tolerance = UE_DOUBLE_KINDA_SMALL_NUMBER) const;
+
+    // Exact segment test, segments touching the box boundary count as intersecting
+    bool IntersectsSegment(const FVector2D& Start, const FVector2D& End) const;
+};
+
+/**
+ * Uniform grid over axis aligned boxes, stored as compressed cell lists
+ * A box is registered in every cell it touches, so queries may return the same box several times
+ * The cell lists use AllocatorType, SScratchRoomGrid keeps them on the memory stack for grids built by a stage
+ */
+template<typename AllocatorType = FDefaultAllocator>
+struct TRoomGrid
+{
+public:
+    FVector2D Origin = FVector2D::ZeroVector;
+    double CellSize = 1.0;
+    int32 NumCellsX = 0;
+    int32 NumCellsY = 0;
+
+    // Items of cell i are CellItems[CellStarts[i]] to CellItems[CellStarts[i + 1] - 1]
+    TArray<int32, AllocatorType> CellStarts;
+    TArray<int32, AllocatorType> CellItems;
+
+    // Builds the grid, the cell size is grown if needed to keep the cell count proportional to the box count
+    void Build(TConstArrayView<FBox2D> Boxes, double InCellSize);
+
+    // Calls Func(ItemIndex) for every box registered in a cell touched by Box
+    template<typename FuncType>
+    void ForEachInBox(const FBox2D& Box, FuncType&& Func) const
+    {
+        if (NumCellsX == 0 || NumCellsY == 0)
+        {
+            return;
+        }
+
+        const FIntPoint MinCell = GetCell(Box.Min);
+        const FIntPoint MaxCell = GetCell(Box.Max);
+
+        for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+        {
+            for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+            {
+                const int32 Cell = Y * NumCellsX + X;
+                for (int32 i = CellStarts[Cell]; i < CellStarts[Cell + 1]; i++)
+                {
+                    Func(CellItems[i]);
+                }
+            }
+        }
+    }
+
+    FIntPoint GetCell(const FVector2D& Point) const
+    {
+        return FIntPoint(
+            FMath::Clamp(FMath::FloorToInt32((Point.X - Origin.X) / CellSize), 0, NumCellsX - 1),
+            FMath::Clamp(FMath::FloorToInt32((Point.Y - Origin.Y) / CellSize), 0, NumCellsY - 1));
+    }
+};
+
+// Grid kept between frames
+using SRoomGrid = TRoomGrid<>;
+
+// Grid built and dropped by one stage of the generation, under its FMemMark
+using SScratchRoomGrid = TRoomGrid<TMemStackAllocator<>>;
@@ -0,0 +1,202 @@
+#include "RoomSeparation.h"
+#include "DungeonStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Room Separation"), STAT_DungeonRoomSeparation, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Overlap Removal"), STAT_DungeonOverlapRemoval, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Overlap Depth"), STAT_DungeonOverlapDepth, STATGROUP_Dungeon);
+
+/**
+ * Deterministic push-apart solver
+ * Each iteration finds overlapping pairs through a uniform grid and pushes both rooms apart
+ * along the line between their centers, each by half of the distance clearing the smallest penetration
+ * @param Rooms - Room footprints, their Location is updated in place
+ * @param MaxIterations - Maximum number of iterations before giving up
+ * @return Whether the rooms ended up without any overlap
+ */
+bool URoomSeparation::SeparateRooms(TArrayView<SRoomFootprint> Rooms, int32 MaxIterations)
+{
+    DUNGEON_SCOPE(STAT_DungeonRoomSeparation);
+
+    FMemMark Mark(FMemStack::Get());
+
+    const int32 NumRooms = Rooms.Num();
+
+    // Use the largest room as cell size so each room only touches a few cells
+    double CellSize = 0.0;
+    for (const SRoomFootprint& Room : Rooms)
+    {
+        CellSize = FMath::Max(CellSize, Room.GetAxisAlignedExtent().GetMax() * 2.0);
+    }
+
+    // The grid and the visitors are rebuilt in place every iteration
+    TDungeonScratchArray<FBox2D> Bounds;
+    Bounds.SetNumUninitialized(NumRooms);
+    TDungeonScratchArray<int32> LastVisitor;
+    SScratchRoomGrid Grid;
+
+    for (int32 Iteration = 0; Iteration < MaxIterations; Iteration++)
+    {
+        for (int32 i = 0; i < NumRooms; i++)
+        {
+            Bounds[i] = Rooms[i].GetBounds();
+        }
+
+        Grid.Build(Bounds, CellSize);
+        LastVisitor.Init(INDEX_NONE, NumRooms);
+        bool bAnyOverlap = false;
+
+        // Pushes are applied immediately (Gauss-Seidel) so crowded areas settle in a few iterations
+        for (int32 i = 0; i < NumRooms; i++)
+        {
+            Grid.ForEachInBox(Bounds[i], [&](int32 j)
+            {
+                // Each pair is handled once, by its lowest index
+                if (j <= i || LastVisitor[j] == i)
+                {
+                    return;
+                }
+                LastVisitor[j] = i;
+
+                const double OverlapX = FMath::Min(Bounds[i].Max.X, Bounds[j].Max.X) - FMath::Max(Bounds[i].Min.X, Bounds[j].Min.X);
+                const double OverlapY = FMath::Min(Bounds[i].Max.Y, Bounds[j].Max.Y) - FMath::Max(Bounds[i].Min.Y, Bounds[j].Min.Y);
+                if (OverlapX <= 0.0 || OverlapY <= 0.0)
+                {
+                    return;
+                }
+
+                bAnyOverlap = true;
+                // Push both rooms apart along the line between their centers so crowded areas expand outwards,
+                // by enough to clear the smallest penetration
+                FVector2D Direction = (Bounds[i].GetCenter() - Bounds[j].GetCenter()).GetSafeNormal();
+                if (Direction.IsZero())
+                {
+                    Direction = FVector2D(1.0, 0.0);
+                }
+
+                const double Penetration = FMath::Min(OverlapX / FMath::Max(FMath::Abs(Direction.X), UE_DOUBLE_KINDA_SMALL_NUMBER),
+                                                      OverlapY / FMath::Max(FMath::Abs(Direction.Y), UE_DOUBLE_KINDA_SMALL_NUMBER));
+                const FVector2D Push = Direction * ((Penetration + SeparationMargin) * 0.5);
+
+                Rooms[i].Location += Push;
+                Rooms[j].Location -= Push;
+                Bounds[i] = Rooms[i].GetBounds();
+                Bounds[j] = Rooms[j].GetBounds();
+            });
+        }
+
+        // Rooms moved while the grid was built, only stop after a full pass without any overlap
+        if (!bAnyOverlap)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Finds overlapping rooms in one pass
+ * Candidate pairs come from a uniform grid over the room bounds, then are confirmed with an exact oriented box test
+ * Rooms are visited in index order and each kept room removes every later room overlapping it,
+ * so the result only depends on the room order
+ * @param Rooms - Room footprints
+ * @param OutOverlapped - Receives one bit per room, set if the room has to be removed
+ */
+void URoomSeparation::FindOverlappedRooms(TConstArrayView<SRoomFootprint> Rooms, TBitArray<TMemStackAllocator<>>& OutOverlapped)
+{
+    DUNGEON_SCOPE(STAT_DungeonOverlapRemoval);
+
+    const int32 NumRooms = Rooms.Num();
+
+    // Sized before the mark, the bits outlive the temporaries below
+    OutOverlapped.Init(false, NumRooms);
+
+    FMemMark Mark(FMemStack::Get());
+
+    TDungeonScratchArray<FBox2D> Bounds;
+    Bounds.Reserve(NumRooms);
+    double CellSize = 0.0;
+    for (const SRoomFootprint& Room : Rooms)
+    {
+        Bounds.Add(Room.GetBounds());
+        CellSize = FMath::Max(CellSize, Bounds.Last().GetSize().GetMax());
+    }
+
+    SScratchRoomGrid Grid;
+    Grid.Build(Bounds, CellSize);
+
+    TDungeonScratchArray<int32> LastVisitor;
+    LastVisitor.Init(INDEX_NONE, NumRooms);
+
+    for (int32 i = 0; i < NumRooms; i++)
+    {
+        if (OutOverlapped[i])
+        {
+            continue;
+        }
+
+        Grid.ForEachInBox(Bounds[i], [&](int32 j)
+        {
+            if (j <= i || OutOverlapped[j] || LastVisitor[j] == i)
+            {
+                return;
+            }
+            LastVisitor[j] = i;
+
+            if (Rooms[i].Overlaps(Rooms[j]))
+            {
+                OutOverlapped[j] = true;
+            }
+        });
+    }
+}
+
+/**
+ * Measures how deep the rooms still overlap
+ * Candidate pairs come from a uniform grid over the room bounds, the depth of a pair being the smallest overlap of
+ * their bounds along X and Y, exact for rooms rotated by quarter turns
+ * @param Rooms - Room footprints
+ * @return Largest depth over every overlapping pair
+ */
+double URoomSeparation::FindMaxOverlapDepth(TConstArrayView<SRoomFootprint> Rooms)
+{
+    DUNGEON_SCOPE(STAT_DungeonOverlapDepth);
+
+    FMemMark Mark(FMemStack::Get());
+
+    const int32 NumRooms = Rooms.Num();
+
+    TDungeonScratchArray<FBox2D> Bounds;
+    Bounds.Reserve(NumRooms);
+    double CellSize = 0.0;
+    for (const SRoomFootprint& Room : Rooms)
+    {
+        Bounds.Add(Room.GetBounds());
+        CellSize = FMath::Max(CellSize, Bounds.Last().GetSize().GetMax());
+    }
+
+    SScratchRoomGrid Grid;
+    Grid.Build(Bounds, CellSize);
+
+    TDungeonScratchArray<int32> LastVisitor;
+    LastVisitor.Init(INDEX_NONE, NumRooms);
+
+    double MaxDepth = 0.0;
+    for (int32 i = 0; i < NumRooms; i++)
+    {
+        Grid.ForEachInBox(Bounds[i], [&](int32 j)
+        {
+            if (j <= i || LastVisitor[j] == i)
+            {
+                return;
+            }
+            LastVisitor[j] = i;
+
+            const double OverlapX = FMath::Min(Bounds[i].Max.X, Bounds[j].Max.X) - FMath::Max(Bounds[i].Min.X, Bounds[j].Min.X);
+            const double OverlapY = FMath::Min(Bounds[i].Max.Y, Bounds[j].Max.Y) - FMath::Max(Bounds[i].Min.Y, Bounds[j].Min.Y);
+            MaxDepth = FMath::Max(MaxDepth, FMath::Min(OverlapX, OverlapY));
+        });
+    }
+
+    return MaxDepth;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "RoomGeometry.h"
+#include "RoomSeparation.generated.h"
+
+UCLASS()
+class TP4_API URoomSeparation : public UObject
+{
+    GENERATED_BODY()
+
+public:
+
+    // Moves the rooms apart until none of them overlap, returns false if MaxIterations was reached first
+    static bool SeparateRooms(TArrayView<SRoomFootprint> Rooms, int32 MaxIterations);
+
+    // Flags the rooms to remove so that no two remaining rooms overlap, a room is kept if it overlaps no lower kept room
+    static void FindOverlappedRooms(TConstArrayView<SRoomFootprint> Rooms, TBitArray<TMemStackAllocator<>>& OutOverlapped);
+
+    // Deepest overlap between two rooms, along the axis of least penetration, zero when no rooms overlap
+    static double FindMaxOverlapDepth(TConstArrayView<SRoomFootprint> Rooms);
+
+    // Gap left between two rooms that have been pushed apart
+    static constexpr double SeparationMargin = 1.0;
+};
@@ -0,0 +1,61 @@
+#include "Misc/AutomationTest.h"
+#include "DungeonGeneration/DungeonLayoutGenerator.h"
+#include "DungeonGeneration/DungeonAllocationCounter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonLayoutRegenerateAllocationsTest, "TP4.Dungeon.LayoutGenerator.RegenerateAllocations",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/**
+ * Generates the same layout twice into one FDungeonLayout, the second generation must reuse the outputs and the memory stack
+ * Only allocations of the game thread are counted, for each combination of corridor routing and merging
+ */
+bool FDungeonLayoutRegenerateAllocationsTest::RunTest(const FString& Parameters)
+{
+    // A few allocations are left to scratch arrays larger than a memory stack page
+    const int64 MaxAllocations = 16;
+
+    SDungeonLayoutParams Params;
+    Params.Seed = 24;
+    Params.RoomCount = 200;
+    Params.Bounds = FVector2D(3000.0, 3000.0);
+    Params.NumCorridorClasses = 3;
+    for (int32 ClassIndex = 0; ClassIndex < 3; ClassIndex++)
+    {
+        SRoomFootprint Footprint;
+        Footprint.Extent = FVector2D(100.0 + 50.0 * ClassIndex, 200.0);
+        Params.RoomFootprints.Add(Footprint);
+    }
+
+    FCountingMalloc Counter(GMalloc);
+    Counter.CountedThreadId = FPlatformTLS::GetCurrentThreadId();
+
+    for (int32 Mode = 0; Mode < 4; Mode++)
+    {
+        Params.bRouteCorridors = (Mode & 1) != 0;
+        Params.bMergeCorridors = (Mode & 2) != 0;
+
+        FDungeonLayout Layout;
+        UDungeonLayoutGenerator::GenerateLayout(Params, Layout);
+
+        FMalloc* PreviousMalloc = GMalloc;
+        Counter.Reset();
+        GMalloc = &Counter;
+
+        UDungeonLayoutGenerator::GenerateLayout(Params, Layout);
+
+        GMalloc = PreviousMalloc;
+
+        const int64 NumAllocations = Counter.NumAllocations;
+        if (NumAllocations > MaxAllocations)
+        {
+            AddError(FString::Printf(TEXT("Regenerating with routing %d and merging %d made %lld allocations, expected at most %lld"),
+                Params.bRouteCorridors, Params.bMergeCorridors, NumAllocations, MaxAllocations));
+        }
+    }
+
+    return true;
+}
+
+#endif
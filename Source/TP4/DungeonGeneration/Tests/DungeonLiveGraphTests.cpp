@@ -0,0 +1,220 @@
+#include "Misc/AutomationTest.h"
+#include "DungeonGeneration/DungeonLiveGraph.h"
+#include "DungeonGeneration/MinSpanTree.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace DungeonLiveGraphTests
+{
+    // Small integer coordinates keep the in-circle determinants of triangles without super vertices exact in double
+    FVector2D MakeRandomPoint(FRandomStream& Stream, int32 Extent)
+    {
+        return FVector2D(Stream.RandRange(0, Extent - 1), Stream.RandRange(0, Extent - 1));
+    }
+
+    // Length of the minimum spanning tree of the points, built from scratch
+    double GetMSTLength(const TArray<FVector2D>& Points)
+    {
+        SDungeonMesh Mesh;
+        UTriangulation::GenerateMesh(Points, Mesh);
+
+        TArray<int32> MST;
+        UMinSpanTree::GenerateMST(Mesh, MST);
+
+        double Length = 0.0;
+        for (int32 EdgeIndex : MST)
+        {
+            Length += FMath::Sqrt(Mesh.GetEdgeLengthSquared(EdgeIndex));
+        }
+        return Length;
+    }
+
+    /**
+     * Checks that the mesh is a Delaunay triangulation of Vertices
+     * Triangles touching the super-triangle only have to be counter-clockwise
+     */
+    bool CheckDelaunay(FAutomationTestBase& Test, const SDelaunayMesh& Mesh, const TArray<int32>& Vertices)
+    {
+        int32 NumTriangles = 0;
+        for (int32 TriangleIndex = 0; TriangleIndex < Mesh.Triangles.Num(); TriangleIndex++)
+        {
+            if (Mesh.IsTriangleRemoved(TriangleIndex))
+            {
+                continue;
+            }
+            NumTriangles++;
+
+            const SMeshTriangle& Triangle = Mesh.Triangles[TriangleIndex];
+            const FVector2D& A = Mesh.Vertices[Triangle.Vertex[0]];
+            const FVector2D& B = Mesh.Vertices[Triangle.Vertex[1]];
+            const FVector2D& C = Mesh.Vertices[Triangle.Vertex[2]];
+            if (UTriangulation::Orient(A, B, C) <= 0.0)
+            {
+                Test.AddError(FString::Printf(TEXT("Triangle %d is not counter-clockwise"), TriangleIndex));
+                return false;
+            }
+
+            if (Mesh.IsSuperVertex(Triangle.Vertex[0]) || Mesh.IsSuperVertex(Triangle.Vertex[1]) || Mesh.IsSuperVertex(Triangle.Vertex[2]))
+            {
+                continue;
+            }
+
+            for (int32 Vertex : Vertices)
+            {
+                if (Vertex != Triangle.Vertex[0] && Vertex != Triangle.Vertex[1] && Vertex != Triangle.Vertex[2] &&
+                    UTriangulation::InCircle(A, B, C, Mesh.Vertices[Vertex]) > 0.0)
+                {
+                    Test.AddError(FString::Printf(TEXT("Vertex %d lies inside the circumcircle of triangle %d"), Vertex, TriangleIndex));
+                    return false;
+                }
+            }
+        }
+
+        // n points inside the super-triangle always make 2n + 1 triangles
+        if (NumTriangles != 2 * Vertices.Num() + 1)
+        {
+            Test.AddError(FString::Printf(TEXT("%d triangles for %d vertices, expected %d"), NumTriangles, Vertices.Num(), 2 * Vertices.Num() + 1));
+            return false;
+        }
+
+        return true;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonMeshRemoveVertexTest, "TP4.Dungeon.Triangulation.RemoveVertex",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/**
+ * Inserts and removes random vertices, the mesh must stay Delaunay after every removal
+ */
+bool FDungeonMeshRemoveVertexTest::RunTest(const FString& Parameters)
+{
+    using namespace DungeonLiveGraphTests;
+
+    const int32 Extent = 1000;
+    FRandomStream Stream(19);
+
+    SDelaunayMesh Mesh;
+    Mesh.Initialize(FVector2D(-20.0 * Extent, -20.0 * Extent), FVector2D(20.0 * Extent, -20.0 * Extent), FVector2D(0.0, 20.0 * Extent));
+
+    TArray<int32> Vertices;
+    for (int32 i = 0; i < 300; i++)
+    {
+        Vertices.AddUnique(Mesh.InsertVertex(MakeRandomPoint(Stream, Extent)));
+    }
+
+    for (int32 Edit = 0; Edit < 600; Edit++)
+    {
+        if (Vertices.Num() > 50 && Stream.FRand() < 0.6f)
+        {
+            const int32 Index = Stream.RandRange(0, Vertices.Num() - 1);
+            Mesh.RemoveVertex(Vertices[Index]);
+            Vertices.RemoveAtSwap(Index);
+
+            if (!CheckDelaunay(*this, Mesh, Vertices))
+            {
+                AddError(FString::Printf(TEXT("Mesh broken by edit %d"), Edit));
+                return false;
+            }
+        }
+        else
+        {
+            Vertices.AddUnique(Mesh.InsertVertex(MakeRandomPoint(Stream, Extent)));
+        }
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonLiveGraphEditTest, "TP4.Dungeon.LiveGraph.RandomEdits",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/**
+ * Adds and removes random nodes, the live tree must stay a minimum spanning tree of the nodes after every edit
+ */
+bool FDungeonLiveGraphEditTest::RunTest(const FString& Parameters)
+{
+    using namespace DungeonLiveGraphTests;
+
+    const int32 Extent = 2000;
+    FRandomStream Stream(2000);
+
+    TArray<FVector2D> Points;
+    while (Points.Num() < 200)
+    {
+        Points.AddUnique(MakeRandomPoint(Stream, Extent));
+    }
+
+    SDungeonMesh Mesh;
+    UTriangulation::GenerateMesh(Points, Mesh);
+    TArray<int32> MST;
+    UMinSpanTree::GenerateMST(Mesh, MST);
+
+    TArray<SNodeEdge> TreeEdges;
+    for (int32 EdgeIndex : MST)
+    {
+        TreeEdges.Add(SNodeEdge(Mesh.GetEdgeStartIndex(EdgeIndex), Mesh.GetEdgeEndIndex(EdgeIndex)));
+    }
+
+    SDungeonLiveGraph Graph;
+    TArray<int32> Nodes;
+    Graph.Build(Points, TreeEdges, FBox2D(FVector2D(-Extent), FVector2D(2.0 * Extent)), Nodes);
+
+    TArray<SNodeEdge> AddedEdges;
+    TArray<SNodeEdge> RemovedEdges;
+    TArray<SNodeEdge> Edges;
+    TArray<FVector2D> Positions;
+
+    for (int32 Edit = 0; Edit < 2000; Edit++)
+    {
+        AddedEdges.Reset();
+        RemovedEdges.Reset();
+
+        if (Nodes.Num() > 20 && Stream.FRand() < 0.5f)
+        {
+            const int32 Index = Stream.RandRange(0, Nodes.Num() - 1);
+            Graph.RemoveNode(Nodes[Index], AddedEdges, RemovedEdges);
+            Nodes.RemoveAtSwap(Index);
+        }
+        else
+        {
+            const int32 Node = Graph.AddNode(MakeRandomPoint(Stream, Extent), AddedEdges, RemovedEdges);
+            if (Node == INDEX_NONE)
+            {
+                continue;
+            }
+            Nodes.Add(Node);
+        }
+
+        Edges.Reset();
+        Graph.GetTreeEdges(Edges);
+        if (Edges.Num() != Nodes.Num() - 1)
+        {
+            AddError(FString::Printf(TEXT("Edit %d: %d tree edges for %d nodes"), Edit, Edges.Num(), Nodes.Num()));
+            return false;
+        }
+
+        double Length = 0.0;
+        for (const SNodeEdge& Edge : Edges)
+        {
+            Length += FVector2D::Distance(Graph.GetNodePosition(Edge.A), Graph.GetNodePosition(Edge.B));
+        }
+
+        Positions.Reset();
+        for (int32 Node : Nodes)
+        {
+            Positions.Add(Graph.GetNodePosition(Node));
+        }
+
+        const double ExpectedLength = GetMSTLength(Positions);
+        if (!FMath::IsNearlyEqual(Length, ExpectedLength, ExpectedLength * 1e-9))
+        {
+            AddError(FString::Printf(TEXT("Edit %d: tree length %.3f, minimum spanning tree length %.3f"), Edit, Length, ExpectedLength));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#endif
@@ -1,32 +1,182 @@
 ﻿#include "Triangulation.h"
+#include "TP4.h"
+#include "DungeonStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Triangulation"), STAT_DungeonTriangulation, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Triangulation Bowyer-Watson"), STAT_DungeonTriangulationBowyerWatson, STATGROUP_Dungeon);
+DECLARE_CYCLE_STAT(TEXT("Triangulation Insertion Order"), STAT_DungeonInsertionOrder, STATGROUP_Dungeon);
 
 /**
- * Implements Bowyer-Watson algorithm for Delaunay triangulation
+ * Implements incremental Delaunay triangulation
+ * Points are inserted in spatially coherent order, located by walking the mesh and legalized with edge flips
+ * @param Points - Array of 2D points to triangulate
+ * @param OutMesh - Indexed mesh receiving the triangles and their unique edges
+ * @param Precision - Scalar type of the predicates, Fixed being exact on points snapped to its grid
+ * Fixed falls back to Double when the super-triangle would not fit the fixed point grid
+ */
+void UTriangulation::GenerateMesh(TConstArrayView<FVector2D> Points, SDungeonMesh& OutMesh, EGeometryPrecision Precision)
+{
+    DUNGEON_SCOPE(STAT_DungeonTriangulation);
+
+    switch (Precision)
+    {
+    case EGeometryPrecision::Float:
+        GenerateMesh<SFloatGeometry>(Points, OutMesh);
+        break;
+    case EGeometryPrecision::Fixed:
+        // A clamped super-triangle would no longer contain the points
+        if (FitsFixedGrid(GenerateSuperTriangle(Points)))
+        {
+            GenerateMesh<SFixedGeometry>(Points, OutMesh);
+            break;
+        }
+        UE_LOG(LogDungeon, Warning, TEXT("Triangulation: %d points are too spread out for the fixed point grid, using double precision"), Points.Num());
+        GenerateMesh<SDoubleGeometry>(Points, OutMesh);
+        break;
+    case EGeometryPrecision::Double:
+    default:
+        GenerateMesh<SDoubleGeometry>(Points, OutMesh);
+        break;
+    }
+}
+
+template<typename PolicyType>
+void UTriangulation::GenerateMesh(TConstArrayView<FVector2D> Points, SDungeonMesh& OutMesh)
+{
+
+    OutMesh.Reset();
+    OutMesh.Vertices.Append(Points.GetData(), Points.Num());
+
+    if (Points.Num() < 3)
+    {
+        return;
+    }
+
+    // The adjacency mesh and the insertion order only live during the triangulation
+    FMemMark Mark(FMemStack::Get());
+
+    // Create initial super-triangle that contains all points
+    STriangle SuperTriangle = GenerateSuperTriangle(Points);
+
+    TDelaunayMesh<PolicyType, TMemStackAllocator<>> Mesh;
+    Mesh.Initialize(SuperTriangle.A, SuperTriangle.B, SuperTriangle.C, Points.Num());
+
+    // Maps Delaunay mesh vertices back to the index of the point they were created from
+    TDungeonScratchArray<int32> PointIndices;
+    PointIndices.Init(INDEX_NONE, Points.Num() + SDelaunayMesh::NumSuperVertices);
+
+    TDungeonScratchArray<int32> InsertionOrder;
+    GetInsertionOrder(Points, InsertionOrder);
+
+    // Insert points in BRIO order so each walk starts close to its target
+    for (int32 PointIndex : InsertionOrder)
+    {
+        const int32 VertexIndex = Mesh.InsertVertex(Points[PointIndex]);
+        if (PointIndices[VertexIndex] == INDEX_NONE)
+        {
+            PointIndices[VertexIndex] = PointIndex;
+        }
+    }
+
+    // Keep only triangles that are not connected to the super-triangle
+    TBitArray<TMemStackAllocator<>> KeptTriangles(false, Mesh.Triangles.Num());
+    OutMesh.Triangles.Reserve(Mesh.Triangles.Num() * 3);
+
+    for (int32 TriangleIndex = 0; TriangleIndex < Mesh.Triangles.Num(); TriangleIndex++)
+    {
+        const SMeshTriangle& Triangle = Mesh.Triangles[TriangleIndex];
+        if (Mesh.IsSuperVertex(Triangle.Vertex[0]) || Mesh.IsSuperVertex(Triangle.Vertex[1]) || Mesh.IsSuperVertex(Triangle.Vertex[2]))
+        {
+            continue;
+        }
+
+        KeptTriangles[TriangleIndex] = true;
+        OutMesh.Triangles.Add(PointIndices[Triangle.Vertex[0]]);
+        OutMesh.Triangles.Add(PointIndices[Triangle.Vertex[1]]);
+        OutMesh.Triangles.Add(PointIndices[Triangle.Vertex[2]]);
+    }
+
+    // Emit each edge once, from the kept triangle with the lowest index
+    OutMesh.Edges.Reserve(OutMesh.Triangles.Num());
+
+    for (int32 TriangleIndex = 0; TriangleIndex < Mesh.Triangles.Num(); TriangleIndex++)
+    {
+        if (!KeptTriangles[TriangleIndex])
+        {
+            continue;
+        }
+
+        const SMeshTriangle& Triangle = Mesh.Triangles[TriangleIndex];
+        for (int32 i = 0; i < 3; i++)
+        {
+            const int32 Neighbor = Triangle.Neighbor[i];
+            if (Neighbor == INDEX_NONE || !KeptTriangles[Neighbor] || Neighbor > TriangleIndex)
+            {
+                OutMesh.Edges.Add(PointIndices[Triangle.Vertex[(i + 1) % 3]]);
+                OutMesh.Edges.Add(PointIndices[Triangle.Vertex[(i + 2) % 3]]);
+            }
+        }
+    }
+}
+
+/**
+ * Generates the Delaunay triangulation as a list of standalone triangles
  * @param Points - Array of 2D points to triangulate
  * @return Array of triangles forming the Delaunay triangulation
  */
 TArray<STriangle> UTriangulation::GenerateTriangulation(const TArray<FVector2D>& Points)
 {
+    SDungeonMesh Mesh;
+    GenerateMesh(Points, Mesh);
+
+    TArray<STriangle> Triangles;
+    Triangles.Reserve(Mesh.NumTriangles());
+
+    for (int32 TriangleIndex = 0; TriangleIndex < Mesh.NumTriangles(); TriangleIndex++)
+    {
+        Triangles.Add(STriangle(Mesh.GetTriangleVertex(TriangleIndex, 0), Mesh.GetTriangleVertex(TriangleIndex, 1), Mesh.GetTriangleVertex(TriangleIndex, 2)));
+    }
+
+    return Triangles;
+}
+
+/**
+ * Implements Bowyer-Watson algorithm for Delaunay triangulation
+ * Quadratic in the number of points, kept as a reference for the incremental implementation
+ * @param Points - Array of 2D points to triangulate
+ * @return Array of triangles forming the Delaunay triangulation
+ */
+TArray<STriangle> UTriangulation::GenerateTriangulationBowyerWatson(const TArray<FVector2D>& Points)
+{
+    DUNGEON_SCOPE(STAT_DungeonTriangulationBowyerWatson);
+
     TArray<STriangle> Triangles;
 
+    // Circumcircles are computed once when a triangle is created, Circles[i] belonging to Triangles[i]
+    SCircumcircleBuffer Circles;
+
     // Create initial super-triangle that contains all points
     STriangle SuperTriangle = GenerateSuperTriangle(Points);
     Triangles.Add(SuperTriangle);
+    Circles.Add(GetCircumcircle(SuperTriangle));
+
+    TArray<int32> BadIndices;
+    TArray<STriangle> BadTriangles;
+    TArray<SEdge> Polygon;
 
     // Process each point to build triangulation
     for (const FVector2D& Point : Points)
     {
         // Find triangles whose circumcircle contains the current point
-        TArray<STriangle> BadTriangles;
-        TArray<SEdge> Polygon;
+        BadIndices.Reset();
+        BadTriangles.Reset();
+        Polygon.Reset();
 
         // Collect triangles that violate the Delaunay condition
-        for (const STriangle& Triangle : Triangles)
+        Circles.FindContaining(Point, BadIndices);
+        for (int32 BadIndex : BadIndices)
         {
-            if (GetCircumcircle(Triangle).ContainsPoint(Point))
-            {
-                BadTriangles.Add(Triangle);
-            }
+            BadTriangles.Add(Triangles[BadIndex]);
         }
 
         // Find boundary edges of the hole created by removed triangles
@@ -75,16 +225,19 @@ TArray<STriangle> UTriangulation::GenerateTriangulation(const TArray<FVector2D>&
             if (!IsShared3) Polygon.AddUnique(Edge3);
         }
 
-        // Remove triangles that violate Delaunay condition
-        for (const STriangle& Triangle : BadTriangles)
+        // Remove triangles that violate Delaunay condition, from the highest index so swapped-in triangles are never bad ones
+        for (int32 i = BadIndices.Num() - 1; i >= 0; --i)
         {
-            Triangles.Remove(Triangle);
+            Triangles.RemoveAtSwap(BadIndices[i], 1, EAllowShrinking::No);
+            Circles.RemoveAtSwap(BadIndices[i]);
         }
 
         // Create new triangles connecting the point to boundary edges
         for (const SEdge& Edge : Polygon)
         {
-            Triangles.Add(STriangle(Edge.Start, Edge.End, Point));
+            const STriangle Triangle(Edge.Start, Edge.End, Point);
+            Triangles.Add(Triangle);
+            Circles.Add(GetCircumcircle(Triangle));
         }
     }
 
@@ -104,7 +257,7 @@ TArray<STriangle> UTriangulation::GenerateTriangulation(const TArray<FVector2D>&
  * Creates a super-triangle that contains all input points
  * Used as initial triangle for Bowyer-Watson algorithm
  */
-STriangle UTriangulation::GenerateSuperTriangle(const TArray<FVector2D>& Points)
+STriangle UTriangulation::GenerateSuperTriangle(TConstArrayView<FVector2D> Points)
 {
     if (Points.Num() == 0)
     {
@@ -112,8 +265,8 @@ STriangle UTriangulation::GenerateSuperTriangle(const TArray<FVector2D>& Points)
     }
 
     // Find bounding box of all points
-    FVector2D MinPoint(FLT_MAX, FLT_MAX);
-    FVector2D MaxPoint(-FLT_MAX, -FLT_MAX);
+    FVector2D MinPoint(DBL_MAX, DBL_MAX);
+    FVector2D MaxPoint(-DBL_MAX, -DBL_MAX);
     for (const FVector2D& Point : Points)
     {
         MinPoint.X = FMath::Min(MinPoint.X, Point.X);
@@ -123,24 +276,42 @@ STriangle UTriangulation::GenerateSuperTriangle(const TArray<FVector2D>& Points)
     }
 
     // Calculate center and size of bounding box
-    FVector2D Center = (MinPoint + MaxPoint) * 0.5f;
-    float Width = MaxPoint.X - MinPoint.X;
-    float Height = MaxPoint.Y - MinPoint.Y;
-    float MaxDimension = FMath::Max(Width, Height);
+    FVector2D Center = (MinPoint + MaxPoint) * 0.5;
+    double Width = MaxPoint.X - MinPoint.X;
+    double Height = MaxPoint.Y - MinPoint.Y;
+    double MaxDimension = FMath::Max(Width, Height);
 
     // Create large equilateral triangle around points
-    float Scale = 20.0f;
-    float TriangleHeight = MaxDimension * Scale * FMath::Sqrt(3.0f) * 0.5f;
-    float HalfWidth = MaxDimension * Scale * 0.5f;
+    double Scale = 20.0;
+    double TriangleHeight = MaxDimension * Scale * FMath::Sqrt(3.0) * 0.5;
+    double HalfWidth = MaxDimension * Scale * 0.5;
 
     // Calculate triangle vertices
     FVector2D A = FVector2D(Center.X, Center.Y + TriangleHeight); // Top
-    FVector2D B = FVector2D(Center.X - HalfWidth, Center.Y - TriangleHeight * 0.5f); // Bottom-left
-    FVector2D C = FVector2D(Center.X + HalfWidth, Center.Y - TriangleHeight * 0.5f); // Bottom-right
+    FVector2D B = FVector2D(Center.X - HalfWidth, Center.Y - TriangleHeight * 0.5); // Bottom-left
+    FVector2D C = FVector2D(Center.X + HalfWidth, Center.Y - TriangleHeight * 0.5); // Bottom-right
 
     return STriangle(A, B, C);
 }
 
+/**
+ * Checks the vertices against the largest coordinate of the fixed point grid
+ * @param Triangle - Triangle to check, usually the super-triangle
+ * @return bool - False if snapping a vertex to the grid would clamp it
+ */
+bool UTriangulation::FitsFixedGrid(const STriangle& Triangle)
+{
+    const double MaxCoordinate = SFixedGeometry::MaxCoordinate * SFixedGeometry::Resolution;
+    for (const FVector2D& Vertex : { Triangle.A, Triangle.B, Triangle.C })
+    {
+        if (FMath::Abs(Vertex.X) > MaxCoordinate || FMath::Abs(Vertex.Y) > MaxCoordinate)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 /**
  * Calculates circumcircle of a triangle
  * Used to check Delaunay condition
@@ -154,27 +325,27 @@ SCircumcircle UTriangulation::GetCircumcircle(const STriangle& Triangle)
     SCircumcircle Circle;
 
     // Calculate determinant for circumcenter calculation
-    float D = 2 * (A.X * (B.Y - C.Y) + B.X * (C.Y - A.Y) + C.X * (A.Y - B.Y));
+    double D = 2 * (A.X * (B.Y - C.Y) + B.X * (C.Y - A.Y) + C.X * (A.Y - B.Y));
 
-    // Handle degenerate case (collinear points)
-    if (FMath::Abs(D) < KINDA_SMALL_NUMBER)
+    // Only exactly collinear points are degenerate, nearly collinear ones get a large but valid circle
+    if (Orient(A, B, C) == 0.0)
     {
         return SCircumcircle();
     }
 
     // Calculate circumcenter coordinates
-    float Ux = ((A.X * A.X + A.Y * A.Y) * (B.Y - C.Y) +
+    double Ux = ((A.X * A.X + A.Y * A.Y) * (B.Y - C.Y) +
         (B.X * B.X + B.Y * B.Y) * (C.Y - A.Y) +
         (C.X * C.X + C.Y * C.Y) * (A.Y - B.Y)) / D;
 
-    float Uy = ((A.X * A.X + A.Y * A.Y) * (C.X - B.X) +
+    double Uy = ((A.X * A.X + A.Y * A.Y) * (C.X - B.X) +
         (B.X * B.X + B.Y * B.Y) * (A.X - C.X) +
         (C.X * C.X + C.Y * C.Y) * (B.X - A.X)) / D;
 
     Circle.Center = FVector2D(Ux, Uy);
 
-    // Calculate the radius
-    Circle.Radius = FVector2D::Distance(Circle.Center, A);
+    // Keep the squared radius, containment tests never need the square root
+    Circle.RadiusSquared = FVector2D::DistSquared(Circle.Center, A);
 
     return Circle;
 }
@@ -185,3 +356,664 @@ bool UTriangulation::SharesVertexWithSuperTriangle(const STriangle& Triangle, co
         Triangle.B == SuperTriangle.A || Triangle.B == SuperTriangle.B || Triangle.B == SuperTriangle.C ||
         Triangle.C == SuperTriangle.A || Triangle.C == SuperTriangle.B || Triangle.C == SuperTriangle.C;
 }
+
+double UTriangulation::Orient(const FVector2D& A, const FVector2D& B, const FVector2D& C)
+{
+    return SDoubleGeometry::Orient(A, B, C);
+}
+
+double UTriangulation::InCircle(const FVector2D& A, const FVector2D& B, const FVector2D& C, const FVector2D& D)
+{
+    return SDoubleGeometry::InCircle(A, B, C, D);
+}
+
+/**
+ * Maps a point of a 65536x65536 grid to its distance along the Hilbert curve
+ */
+static uint32 GetHilbertIndex(uint32 X, uint32 Y)
+{
+    const uint32 GridSize = 1u << 16;
+    uint32 Index = 0;
+
+    for (uint32 Step = GridSize >> 1; Step > 0; Step >>= 1)
+    {
+        const uint32 RX = (X & Step) ? 1 : 0;
+        const uint32 RY = (Y & Step) ? 1 : 0;
+        Index += Step * Step * ((3 * RX) ^ RY);
+
+        // Rotate the quadrant so the curve stays continuous
+        if (RY == 0)
+        {
+            if (RX == 1)
+            {
+                X = GridSize - 1 - X;
+                Y = GridSize - 1 - Y;
+            }
+            Swap(X, Y);
+        }
+    }
+
+    return Index;
+}
+
+/**
+ * Computes a biased randomized insertion order (BRIO)
+ * Points are split in rounds of doubling size, each round being sorted along a Hilbert curve
+ * Rounds are derived from a hash of the point index so the order is deterministic
+ * @param Points - Points to insert
+ * @param OutOrder - Receives the point indices in insertion order
+ */
+void UTriangulation::GetInsertionOrder(TConstArrayView<FVector2D> Points, TDungeonScratchArray<int32>& OutOrder)
+{
+    DUNGEON_SCOPE(STAT_DungeonInsertionOrder);
+
+    FVector2D MinPoint(DBL_MAX, DBL_MAX);
+    FVector2D MaxPoint(-DBL_MAX, -DBL_MAX);
+    for (const FVector2D& Point : Points)
+    {
+        MinPoint = FVector2D::Min(MinPoint, Point);
+        MaxPoint = FVector2D::Max(MaxPoint, Point);
+    }
+
+    const FVector2D Size = MaxPoint - MinPoint;
+    const double Scale = 65535.0 / FMath::Max(FMath::Max(Size.X, Size.Y), UE_DOUBLE_SMALL_NUMBER);
+    const uint32 MaxRound = 31;
+
+    TDungeonScratchArray<uint64> Keys;
+    Keys.Reserve(Points.Num());
+
+    for (int32 i = 0; i < Points.Num(); i++)
+    {
+        // Points with more trailing zeros in their hash belong to earlier (smaller) rounds
+        uint32 Hash = static_cast<uint32>(i) * 0x9E3779B9u;
+        Hash ^= Hash >> 16;
+        Hash *= 0x85EBCA6Bu;
+        Hash ^= Hash >> 13;
+        const uint32 Round = MaxRound - FMath::Min(FMath::CountTrailingZeros(Hash | (1u << MaxRound)), MaxRound);
+
+        const uint32 X = static_cast<uint32>((Points[i].X - MinPoint.X) * Scale);
+        const uint32 Y = static_cast<uint32>((Points[i].Y - MinPoint.Y) * Scale);
+
+        // Round in the high bits, Hilbert index in the low bits: sorting the key sorts by round first
+        Keys.Add((static_cast<uint64>(Round) << 32) | GetHilbertIndex(X, Y));
+    }
+
+    OutOrder.Reset(Points.Num());
+    for (int32 i = 0; i < Points.Num(); i++)
+    {
+        OutOrder.Add(i);
+    }
+
+    OutOrder.Sort([&Keys](int32 A, int32 B)
+    {
+        return Keys[A] < Keys[B] || (Keys[A] == Keys[B] && A < B);
+    });
+}
+
+/**
+ * Creates the mesh with a single counter-clockwise super-triangle
+ * Inserting n points inside the super-triangle makes 2n + 1 triangles, the buffers are reserved for them up front
+ */
+template<typename PolicyType, typename AllocatorType>
+void TDelaunayMesh<PolicyType, AllocatorType>::Initialize(const FVector2D& SuperA, const FVector2D& SuperB, const FVector2D& SuperC, int32 NumPoints)
+{
+    Vertices.Reset(NumPoints + NumSuperVertices);
+    Triangles.Reset(2 * NumPoints + 1);
+
+    const PointType A = PolicyType::FromWorld(SuperA);
+    const PointType B = PolicyType::FromWorld(SuperB);
+    const PointType C = PolicyType::FromWorld(SuperC);
+
+    Vertices.Add(A);
+    if (PolicyType::OrientSign(A, B, C) > 0)
+    {
+        Vertices.Add(B);
+        Vertices.Add(C);
+    }
+    else
+    {
+        Vertices.Add(C);
+        Vertices.Add(B);
+    }
+
+    Triangles.Add(SMeshTriangle{ { 0, 1, 2 }, { INDEX_NONE, INDEX_NONE, INDEX_NONE } });
+    FreeTriangles.Reset();
+    LastTriangle = 0;
+}
+
+template<typename PolicyType, typename AllocatorType>
+bool TDelaunayMesh<PolicyType, AllocatorType>::IsInside(const FVector2D& WorldPoint) const
+{
+    const PointType Point = PolicyType::FromWorld(WorldPoint);
+    return PolicyType::OrientSign(Vertices[0], Vertices[1], Point) > 0 &&
+           PolicyType::OrientSign(Vertices[1], Vertices[2], Point) > 0 &&
+           PolicyType::OrientSign(Vertices[2], Vertices[0], Point) > 0;
+}
+
+/**
+ * Inserts a point inside the super-triangle
+ * Splits the containing triangle (or the two triangles sharing the edge the point lies on), then flips illegal edges
+ */
+template<typename PolicyType, typename AllocatorType>
+int32 TDelaunayMesh<PolicyType, AllocatorType>::InsertVertex(const FVector2D& WorldPoint)
+{
+    const PointType Point = PolicyType::FromWorld(WorldPoint);
+    const int32 TriangleIndex = LocateTriangle(Point);
+    const SMeshTriangle& Triangle = Triangles[TriangleIndex];
+
+    // Ignore duplicated points, including distinct points snapped to the same fixed point cell
+    for (int32 i = 0; i < 3; i++)
+    {
+        if (Vertices[Triangle.Vertex[i]] == Point)
+        {
+            return Triangle.Vertex[i];
+        }
+    }
+
+    // Check if the point lies exactly on one of the edges
+    int32 EdgeIndex = INDEX_NONE;
+    for (int32 i = 0; i < 3; i++)
+    {
+        if (PolicyType::OrientSign(Vertices[Triangle.Vertex[(i + 1) % 3]], Vertices[Triangle.Vertex[(i + 2) % 3]], Point) == 0)
+        {
+            EdgeIndex = i;
+            break;
+        }
+    }
+
+    const int32 VertexIndex = Vertices.Add(Point);
+
+    if (EdgeIndex != INDEX_NONE && Triangle.Neighbor[EdgeIndex] != INDEX_NONE)
+    {
+        SplitEdge(TriangleIndex, EdgeIndex, VertexIndex);
+    }
+    else
+    {
+        SplitTriangle(TriangleIndex, VertexIndex);
+    }
+
+    Legalize();
+
+    return VertexIndex;
+}
+
+/**
+ * Finds the triangle containing a point by walking from the last inserted triangle
+ * Each step crosses an edge that has the point on its outer side
+ */
+template<typename PolicyType, typename AllocatorType>
+int32 TDelaunayMesh<PolicyType, AllocatorType>::LocateTriangle(const PointType& Point) const
+{
+    int32 Current = Triangles.IsValidIndex(LastTriangle) ? LastTriangle : 0;
+    int32 StartEdge = 0;
+
+    for (int32 Step = 0; Step < Triangles.Num(); Step++)
+    {
+        const SMeshTriangle& Triangle = Triangles[Current];
+        int32 Next = INDEX_NONE;
+        bool bOutside = false;
+
+        // Rotate the first tested edge to avoid cycling around a vertex
+        for (int32 k = 0; k < 3; k++)
+        {
+            const int32 i = (StartEdge + k) % 3;
+            if (PolicyType::OrientSign(Vertices[Triangle.Vertex[(i + 1) % 3]], Vertices[Triangle.Vertex[(i + 2) % 3]], Point) < 0)
+            {
+                Next = Triangle.Neighbor[i];
+                bOutside = true;
+                break;
+            }
+        }
+
+        if (!bOutside)
+        {
+            return Current;
+        }
+
+        if (Next == INDEX_NONE)
+        {
+            break;
+        }
+
+        Current = Next;
+        StartEdge = (StartEdge + 1) % 3;
+    }
+
+    // Fallback to a linear scan if the walk left the mesh (point outside the super-triangle)
+    for (int32 TriangleIndex = 0; TriangleIndex < Triangles.Num(); TriangleIndex++)
+    {
+        const SMeshTriangle& Triangle = Triangles[TriangleIndex];
+        if (!IsTriangleRemoved(TriangleIndex) &&
+            PolicyType::OrientSign(Vertices[Triangle.Vertex[0]], Vertices[Triangle.Vertex[1]], Point) >= 0 &&
+            PolicyType::OrientSign(Vertices[Triangle.Vertex[1]], Vertices[Triangle.Vertex[2]], Point) >= 0 &&
+            PolicyType::OrientSign(Vertices[Triangle.Vertex[2]], Vertices[Triangle.Vertex[0]], Point) >= 0)
+        {
+            return TriangleIndex;
+        }
+    }
+
+    return Current;
+}
+
+/**
+ * Splits a triangle into three triangles around a new vertex
+ * The new vertex is stored first in every created triangle
+ */
+template<typename PolicyType, typename AllocatorType>
+void TDelaunayMesh<PolicyType, AllocatorType>::SplitTriangle(int32 TriangleIndex, int32 VertexIndex)
+{
+    const SMeshTriangle Old = Triangles[TriangleIndex];
+    const int32 A = Old.Vertex[0], B = Old.Vertex[1], C = Old.Vertex[2];
+    const int32 First = TriangleIndex;
+    const int32 Second = AllocateTriangle();
+    const int32 Third = AllocateTriangle();
+
+    Triangles[First] = SMeshTriangle{ { VertexIndex, B, C }, { Old.Neighbor[0], Second, Third } };
+    Triangles[Second] = SMeshTriangle{ { VertexIndex, C, A }, { Old.Neighbor[1], Third, First } };
+    Triangles[Third] = SMeshTriangle{ { VertexIndex, A, B }, { Old.Neighbor[2], First, Second } };
+
+    ReplaceNeighbor(Old.Neighbor[1], TriangleIndex, Second);
+    ReplaceNeighbor(Old.Neighbor[2], TriangleIndex, Third);
+
+    LegalizeStack.Add(First);
+    LegalizeStack.Add(Second);
+    LegalizeStack.Add(Third);
+    LastTriangle = First;
+}
+
+/**
+ * Splits the two triangles sharing an edge into four triangles around a new vertex lying on that edge
+ * The new vertex is stored first in every created triangle
+ */
+template<typename PolicyType, typename AllocatorType>
+void TDelaunayMesh<PolicyType, AllocatorType>::SplitEdge(int32 TriangleIndex, int32 EdgeIndex, int32 VertexIndex)
+{
+    const SMeshTriangle Old = Triangles[TriangleIndex];
+    const int32 A = Old.Vertex[EdgeIndex];
+    const int32 B = Old.Vertex[(EdgeIndex + 1) % 3];
+    const int32 C = Old.Vertex[(EdgeIndex + 2) % 3];
+    const int32 NeighborCA = Old.Neighbor[(EdgeIndex + 1) % 3];
+    const int32 NeighborAB = Old.Neighbor[(EdgeIndex + 2) % 3];
+
+    const int32 OppositeIndex = Old.Neighbor[EdgeIndex];
+    const SMeshTriangle Opposite = Triangles[OppositeIndex];
+    int32 OppositeEdge = 0;
+    while (Opposite.Neighbor[OppositeEdge] != TriangleIndex)
+    {
+        OppositeEdge++;
+    }
+    const int32 D = Opposite.Vertex[OppositeEdge];
+    const int32 NeighborBD = Opposite.Neighbor[(OppositeEdge + 1) % 3];
+    const int32 NeighborDC = Opposite.Neighbor[(OppositeEdge + 2) % 3];
+
+    const int32 NewTriangle = AllocateTriangle();
+    const int32 NewOpposite = AllocateTriangle();
+
+    Triangles[TriangleIndex] = SMeshTriangle{ { VertexIndex, A, B }, { NeighborAB, OppositeIndex, NewTriangle } };
+    Triangles[OppositeIndex] = SMeshTriangle{ { VertexIndex, B, D }, { NeighborBD, NewOpposite, TriangleIndex } };
+    Triangles[NewTriangle] = SMeshTriangle{ { VertexIndex, C, A }, { NeighborCA, TriangleIndex, NewOpposite } };
+    Triangles[NewOpposite] = SMeshTriangle{ { VertexIndex, D, C }, { NeighborDC, NewTriangle, OppositeIndex } };
+
+    ReplaceNeighbor(NeighborCA, TriangleIndex, NewTriangle);
+    ReplaceNeighbor(NeighborDC, OppositeIndex, NewOpposite);
+
+    LegalizeStack.Add(TriangleIndex);
+    LegalizeStack.Add(OppositeIndex);
+    LegalizeStack.Add(NewTriangle);
+    LegalizeStack.Add(NewOpposite);
+    LastTriangle = TriangleIndex;
+}
+
+/**
+ * Restores the Delaunay condition around the last inserted vertex
+ * Every triangle on the stack has the new vertex first, its opposite edge is flipped if illegal
+ */
+template<typename PolicyType, typename AllocatorType>
+void TDelaunayMesh<PolicyType, AllocatorType>::Legalize()
+{
+    while (LegalizeStack.Num() > 0)
+    {
+        const int32 TriangleIndex = LegalizeStack.Pop(EAllowShrinking::No);
+        const SMeshTriangle& Triangle = Triangles[TriangleIndex];
+        const int32 OppositeIndex = Triangle.Neighbor[0];
+
+        if (OppositeIndex == INDEX_NONE)
+        {
+            continue;
+        }
+
+        const SMeshTriangle& Opposite = Triangles[OppositeIndex];
+        int32 OppositeEdge = 0;
+        while (Opposite.Neighbor[OppositeEdge] != TriangleIndex)
+        {
+            OppositeEdge++;
+        }
+
+        const PointType& OppositePoint = Vertices[Opposite.Vertex[OppositeEdge]];
+        if (PolicyType::InCircleSign(Vertices[Triangle.Vertex[0]], Vertices[Triangle.Vertex[1]], Vertices[Triangle.Vertex[2]], OppositePoint) > 0)
+        {
+            FlipEdge(TriangleIndex, 0);
+
+            // Both flipped triangles keep the new vertex first and expose a new opposite edge
+            LegalizeStack.Add(TriangleIndex);
+            LegalizeStack.Add(OppositeIndex);
+        }
+    }
+}
+
+/**
+ * Flips the edge opposite to Vertex[EdgeIndex] of a triangle
+ * Triangle (A, B, C) and its neighbor (D, C, B) become (A, B, D) and (A, D, C)
+ */
+template<typename PolicyType, typename AllocatorType>
+void TDelaunayMesh<PolicyType, AllocatorType>::FlipEdge(int32 TriangleIndex, int32 EdgeIndex)
+{
+    const SMeshTriangle Old = Triangles[TriangleIndex];
+    const int32 A = Old.Vertex[EdgeIndex];
+    const int32 B = Old.Vertex[(EdgeIndex + 1) % 3];
+    const int32 C = Old.Vertex[(EdgeIndex + 2) % 3];
+    const int32 NeighborCA = Old.Neighbor[(EdgeIndex + 1) % 3];
+    const int32 NeighborAB = Old.Neighbor[(EdgeIndex + 2) % 3];
+
+    const int32 OppositeIndex = Old.Neighbor[EdgeIndex];
+    const SMeshTriangle Opposite = Triangles[OppositeIndex];
+    int32 OppositeEdge = 0;
+    while (Opposite.Neighbor[OppositeEdge] != TriangleIndex)
+    {
+        OppositeEdge++;
+    }
+    const int32 D = Opposite.Vertex[OppositeEdge];
+    const int32 NeighborBD = Opposite.Neighbor[(OppositeEdge + 1) % 3];
+    const int32 NeighborDC = Opposite.Neighbor[(OppositeEdge + 2) % 3];
+
+    Triangles[TriangleIndex] = SMeshTriangle{ { A, B, D }, { NeighborBD, OppositeIndex, NeighborAB } };
+    Triangles[OppositeIndex] = SMeshTriangle{ { A, D, C }, { NeighborDC, NeighborCA, TriangleIndex } };
+
+    ReplaceNeighbor(NeighborBD, OppositeIndex, TriangleIndex);
+    ReplaceNeighbor(NeighborCA, TriangleIndex, OppositeIndex);
+}
+
+template<typename PolicyType, typename AllocatorType>
+void TDelaunayMesh<PolicyType, AllocatorType>::ReplaceNeighbor(int32 TriangleIndex, int32 OldNeighbor, int32 NewNeighbor)
+{
+    if (TriangleIndex == INDEX_NONE)
+    {
+        return;
+    }
+
+    for (int32& Neighbor : Triangles[TriangleIndex].Neighbor)
+    {
+        if (Neighbor == OldNeighbor)
+        {
+            Neighbor = NewNeighbor;
+            return;
+        }
+    }
+}
+
+template<typename PolicyType, typename AllocatorType>
+void TDelaunayMesh<PolicyType, AllocatorType>::SetNeighborAcrossEdge(int32 TriangleIndex, int32 A, int32 B, int32 NewNeighbor)
+{
+    if (TriangleIndex == INDEX_NONE)
+    {
+        return;
+    }
+
+    SMeshTriangle& Triangle = Triangles[TriangleIndex];
+    for (int32 i = 0; i < 3; i++)
+    {
+        if (Triangle.Vertex[i] != A && Triangle.Vertex[i] != B)
+        {
+            Triangle.Neighbor[i] = NewNeighbor;
+            return;
+        }
+    }
+}
+
+template<typename PolicyType, typename AllocatorType>
+int32 TDelaunayMesh<PolicyType, AllocatorType>::AllocateTriangle()
+{
+    if (FreeTriangles.Num() > 0)
+    {
+        return FreeTriangles.Pop(EAllowShrinking::No);
+    }
+
+    return Triangles.AddUninitialized();
+}
+
+/**
+ * Finds a triangle using a vertex
+ * The walk ends in a triangle whose closure contains the vertex position, which can only be one of its corners
+ */
+template<typename PolicyType, typename AllocatorType>
+int32 TDelaunayMesh<PolicyType, AllocatorType>::FindVertexTriangle(int32 VertexIndex) const
+{
+    const int32 TriangleIndex = LocateTriangle(Vertices[VertexIndex]);
+    const SMeshTriangle& Triangle = Triangles[TriangleIndex];
+    if (Triangle.Vertex[0] == VertexIndex || Triangle.Vertex[1] == VertexIndex || Triangle.Vertex[2] == VertexIndex)
+    {
+        // Lookups usually go through nearby vertices, start the next walk from here
+        LastTriangle = TriangleIndex;
+        return TriangleIndex;
+    }
+
+    return INDEX_NONE;
+}
+
+/**
+ * Walks around a vertex from triangle to triangle
+ * In the counter-clockwise triangle (V, B, C) the next triangle around V shares the edge (V, C), opposite to B
+ */
+template<typename PolicyType, typename AllocatorType>
+void TDelaunayMesh<PolicyType, AllocatorType>::GetVertexNeighbors(int32 VertexIndex, TArray<int32>& OutNeighbors) const
+{
+    const int32 StartTriangle = FindVertexTriangle(VertexIndex);
+    int32 Current = StartTriangle;
+
+    while (Current != INDEX_NONE)
+    {
+        const SMeshTriangle& Triangle = Triangles[Current];
+        const int32 Corner = Triangle.Vertex[0] == VertexIndex ? 0 : (Triangle.Vertex[1] == VertexIndex ? 1 : 2);
+        OutNeighbors.Add(Triangle.Vertex[(Corner + 1) % 3]);
+
+        Current = Triangle.Neighbor[(Corner + 1) % 3];
+        if (Current == StartTriangle)
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * Removes a vertex inserted in the mesh
+ * The triangles around the vertex form a star-shaped polygon, which is retriangulated by clipping Delaunay ears:
+ * an ear is kept when it is convex and no other polygon vertex lies inside its circumcircle, so no flip is needed afterwards
+ * The polygon has as many vertices as the removed vertex had neighbors, usually around six
+ */
+template<typename PolicyType, typename AllocatorType>
+void TDelaunayMesh<PolicyType, AllocatorType>::RemoveVertex(int32 VertexIndex)
+{
+    const int32 StartTriangle = IsSuperVertex(VertexIndex) ? INDEX_NONE : FindVertexTriangle(VertexIndex);
+    if (StartTriangle == INDEX_NONE)
+    {
+        return;
+    }
+
+    // Polygon around the vertex, counter-clockwise, with the outer triangle across each of its edges
+    TArray<int32, TInlineAllocator<16>> Polygon;
+    TArray<int32, TInlineAllocator<16>> OuterTriangles;
+    TArray<int32, TInlineAllocator<16>> Star;
+
+    int32 Current = StartTriangle;
+    do
+    {
+        const SMeshTriangle& Triangle = Triangles[Current];
+        const int32 Corner = Triangle.Vertex[0] == VertexIndex ? 0 : (Triangle.Vertex[1] == VertexIndex ? 1 : 2);
+        Polygon.Add(Triangle.Vertex[(Corner + 1) % 3]);
+        OuterTriangles.Add(Triangle.Neighbor[Corner]);
+        Star.Add(Current);
+        Current = Triangle.Neighbor[(Corner + 1) % 3];
+    }
+    while (Current != StartTriangle && Current != INDEX_NONE);
+
+    // Clip ears until a single triangle is left
+    TArray<int32, TInlineAllocator<16>> Remaining = Polygon;
+    TArray<int32, TInlineAllocator<48>> NewVertices;
+
+    while (Remaining.Num() > 3)
+    {
+        const int32 NumRemaining = Remaining.Num();
+        int32 Ear = INDEX_NONE;
+        int32 ConvexEar = INDEX_NONE;
+
+        for (int32 i = 0; i < NumRemaining && Ear == INDEX_NONE; i++)
+        {
+            const PointType& A = Vertices[Remaining[(i + NumRemaining - 1) % NumRemaining]];
+            const PointType& B = Vertices[Remaining[i]];
+            const PointType& C = Vertices[Remaining[(i + 1) % NumRemaining]];
+            if (PolicyType::OrientSign(A, B, C) <= 0)
+            {
+                continue;
+            }
+
+            if (ConvexEar == INDEX_NONE)
+            {
+                ConvexEar = i;
+            }
+
+            bool bEmpty = true;
+            for (int32 j = 2; j < NumRemaining - 1 && bEmpty; j++)
+            {
+                bEmpty = PolicyType::InCircleSign(A, B, C, Vertices[Remaining[(i + j) % NumRemaining]]) <= 0;
+            }
+
+            if (bEmpty)
+            {
+                Ear = i;
+            }
+        }
+
+        // With floating point predicates rounding can reject every ear of a nearly cocircular polygon, any convex ear then keeps the mesh valid
+        Ear = Ear != INDEX_NONE ? Ear : FMath::Max(ConvexEar, 0);
+
+        NewVertices.Add(Remaining[(Ear + NumRemaining - 1) % NumRemaining]);
+        NewVertices.Add(Remaining[Ear]);
+        NewVertices.Add(Remaining[(Ear + 1) % NumRemaining]);
+        Remaining.RemoveAt(Ear);
+    }
+    NewVertices.Append(Remaining);
+
+    // Reuse the star slots, the two left over are released
+    const int32 NumNewTriangles = NewVertices.Num() / 3;
+    for (int32 i = 0; i < NumNewTriangles; i++)
+    {
+        Triangles[Star[i]] = SMeshTriangle{ { NewVertices[i * 3], NewVertices[i * 3 + 1], NewVertices[i * 3 + 2] }, { INDEX_NONE, INDEX_NONE, INDEX_NONE } };
+    }
+    for (int32 i = NumNewTriangles; i < Star.Num(); i++)
+    {
+        Triangles[Star[i]].Vertex[0] = INDEX_NONE;
+        FreeTriangles.Add(Star[i]);
+    }
+
+    // Connect the new triangles to each other, then to the triangles around the polygon
+    for (int32 i = 0; i < NumNewTriangles; i++)
+    {
+        SMeshTriangle& Triangle = Triangles[Star[i]];
+        for (int32 Edge = 0; Edge < 3; Edge++)
+        {
+            const int32 A = Triangle.Vertex[(Edge + 1) % 3];
+            const int32 B = Triangle.Vertex[(Edge + 2) % 3];
+
+            const int32 PolygonEdge = Polygon.Find(A);
+            if (Polygon[(PolygonEdge + 1) % Polygon.Num()] == B)
+            {
+                Triangle.Neighbor[Edge] = OuterTriangles[PolygonEdge];
+                SetNeighborAcrossEdge(OuterTriangles[PolygonEdge], A, B, Star[i]);
+                continue;
+            }
+
+            // Diagonal, shared with the new triangle holding it in the opposite direction
+            for (int32 j = 0; j < NumNewTriangles; j++)
+            {
+                const SMeshTriangle& Other = Triangles[Star[j]];
+                if (j != i && ((Other.Vertex[0] == B && Other.Vertex[1] == A) ||
+                               (Other.Vertex[1] == B && Other.Vertex[2] == A) ||
+                               (Other.Vertex[2] == B && Other.Vertex[0] == A)))
+                {
+                    Triangle.Neighbor[Edge] = Star[j];
+                    break;
+                }
+            }
+        }
+    }
+
+    LastTriangle = Star[0];
+}
+
+int32 SCircumcircleBuffer::Add(const SCircumcircle& Circle)
+{
+    CenterX.Add(Circle.Center.X);
+    CenterY.Add(Circle.Center.Y);
+    return RadiusSquared.Add(Circle.RadiusSquared);
+}
+
+void SCircumcircleBuffer::RemoveAtSwap(int32 Index)
+{
+    CenterX.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    CenterY.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    RadiusSquared.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
+
+void SCircumcircleBuffer::Reset()
+{
+    CenterX.Reset();
+    CenterY.Reset();
+    RadiusSquared.Reset();
+}
+
+/**
+ * Batched in-circle kernel
+ * Tests four circumcircles per iteration with the engine vector registers (SSE/AVX/NEON, scalar fallback on other platforms)
+ */
+void SCircumcircleBuffer::FindContaining(const FVector2D& Point, TArray<int32>& OutIndices) const
+{
+    const int32 Num = RadiusSquared.Num();
+    const double* CenterXData = CenterX.GetData();
+    const double* CenterYData = CenterY.GetData();
+    const double* RadiusSquaredData = RadiusSquared.GetData();
+
+    const VectorRegister4Double PointX = VectorSetFloat1(Point.X);
+    const VectorRegister4Double PointY = VectorSetFloat1(Point.Y);
+
+    int32 i = 0;
+    for (; i + 4 <= Num; i += 4)
+    {
+        const VectorRegister4Double DeltaX = VectorSubtract(VectorLoad(CenterXData + i), PointX);
+        const VectorRegister4Double DeltaY = VectorSubtract(VectorLoad(CenterYData + i), PointY);
+        const VectorRegister4Double DistSquared = VectorMultiplyAdd(DeltaX, DeltaX, VectorMultiply(DeltaY, DeltaY));
+
+        // One bit per lane whose circumcircle contains the point
+        uint32 Mask = static_cast<uint32>(VectorMaskBits(VectorCompareLE(DistSquared, VectorLoad(RadiusSquaredData + i))));
+        while (Mask != 0)
+        {
+            OutIndices.Add(i + static_cast<int32>(FMath::CountTrailingZeros(Mask)));
+            Mask &= Mask - 1;
+        }
+    }
+
+    // Remaining circumcircles
+    for (; i < Num; i++)
+    {
+        const double DeltaX = CenterXData[i] - Point.X;
+        const double DeltaY = CenterYData[i] - Point.Y;
+        if (DeltaX * DeltaX + DeltaY * DeltaY <= RadiusSquaredData[i])
+        {
+            OutIndices.Add(i);
+        }
+    }
+}
+
+template struct TDelaunayMesh<SDoubleGeometry, FDefaultAllocator>;
+template struct TDelaunayMesh<SFloatGeometry, TMemStackAllocator<>>;
+template struct TDelaunayMesh<SDoubleGeometry, TMemStackAllocator<>>;
+template struct TDelaunayMesh<SFixedGeometry, TMemStackAllocator<>>;
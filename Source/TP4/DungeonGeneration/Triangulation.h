@@ -2,6 +2,9 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "DungeonMesh.h"
+#include "DungeonScratch.h"
+#include "GeometryPolicy.h"
 #include "Triangulation.generated.h"
 
 /**
@@ -15,12 +18,19 @@ public:
 
     STriangle(FVector2D InA, FVector2D InB, FVector2D InC)
     {
-        // Sort vertices to ensure consistent ordering for comparison
-        TArray<FVector2D> Vertices = { InA, InB, InC };
-        Vertices.Sort();
-        A = Vertices[0];
-        B = Vertices[1];
-        C = Vertices[2];
+        // Sort vertices in place to ensure consistent ordering for comparison
+        if (IsLess(InB, InA)) Swap(InA, InB);
+        if (IsLess(InC, InB)) Swap(InB, InC);
+        if (IsLess(InB, InA)) Swap(InA, InB);
+        A = InA;
+        B = InB;
+        C = InC;
+    }
+
+    // Lexicographic ordering, same as the one used by SEdge
+    static bool IsLess(const FVector2D& Lhs, const FVector2D& Rhs)
+    {
+        return Lhs.X < Rhs.X || (Lhs.X == Rhs.X && Lhs.Y < Rhs.Y);
     }
 
     // Equality operator
@@ -68,16 +78,125 @@ public:
 struct SCircumcircle
 {
 public:
-    FVector2D Center;
-    float Radius;
+    FVector2D Center = FVector2D::ZeroVector;
+
+    // Squared radius, negative for degenerate triangles so no point is ever contained
+    double RadiusSquared = -1.0;
 
     // Checks if a point lies within the circumcircle
     bool ContainsPoint(const FVector2D& Point) const
     {
-        return FVector2D::Distance(Center, Point) <= Radius;
+        return FVector2D::DistSquared(Center, Point) <= RadiusSquared;
     }
 };
 
+/**
+ * Circumcircles cached in structure-of-arrays layout
+ * Lets one point be tested against several circumcircles per vector instruction
+ */
+struct SCircumcircleBuffer
+{
+public:
+    TArray<double> CenterX;
+    TArray<double> CenterY;
+    TArray<double> RadiusSquared;
+
+    int32 Add(const SCircumcircle& Circle);
+
+    void RemoveAtSwap(int32 Index);
+
+    void Reset();
+
+    // Appends the indices of every circumcircle containing the point, in increasing order
+    void FindContaining(const FVector2D& Point, TArray<int32>& OutIndices) const;
+};
+
+/**
+ * Triangle of the incremental Delaunay mesh
+ * Vertices are stored counter-clockwise as indices into the mesh vertex buffer
+ * Neighbor[i] is the triangle across the edge opposite to Vertex[i]
+ */
+struct SMeshTriangle
+{
+public:
+    int32 Vertex[3];
+    int32 Neighbor[3];
+};
+
+/**
+ * Triangle adjacency mesh used by the incremental Delaunay triangulation
+ * Points are located by walking the mesh and the Delaunay condition is restored with edge flips
+ * PolicyType selects the coordinates and the predicates (see GeometryPolicy.h), points are converted when inserted
+ * The buffers use AllocatorType, the triangulation builds its mesh on the memory stack
+ */
+template<typename PolicyType = SDoubleGeometry, typename AllocatorType = FDefaultAllocator>
+struct TDelaunayMesh
+{
+public:
+    using PointType = typename PolicyType::PointType;
+
+    TArray<PointType, AllocatorType> Vertices;
+    TArray<SMeshTriangle, AllocatorType> Triangles;
+
+    // Number of vertices belonging to the super-triangle (stored first in the vertex buffer)
+    static constexpr int32 NumSuperVertices = 3;
+
+    // Creates the enclosing super-triangle, must be called before inserting any point
+    // NumPoints is the number of points about to be inserted, the buffers are sized for them
+    void Initialize(const FVector2D& SuperA, const FVector2D& SuperB, const FVector2D& SuperC, int32 NumPoints = 0);
+
+    // Inserts a point and restores the Delaunay condition, returns its vertex index (or the existing one for duplicates)
+    int32 InsertVertex(const FVector2D& Point);
+
+    // Checks whether a vertex index refers to the super-triangle
+    bool IsSuperVertex(int32 VertexIndex) const { return VertexIndex < NumSuperVertices; }
+
+    // Checks whether a point lies strictly inside the super-triangle, points outside can't be inserted
+    bool IsInside(const FVector2D& Point) const;
+
+    // Removes a vertex and retriangulates the hole it leaves, only the triangles around the vertex are touched
+    void RemoveVertex(int32 VertexIndex);
+
+    // Appends the vertices sharing an edge with a vertex, counter-clockwise
+    void GetVertexNeighbors(int32 VertexIndex, TArray<int32>& OutNeighbors) const;
+
+    // Removed triangles are kept in the buffer with their first vertex set to INDEX_NONE
+    bool IsTriangleRemoved(int32 TriangleIndex) const { return Triangles[TriangleIndex].Vertex[0] == INDEX_NONE; }
+
+private:
+    int32 LocateTriangle(const PointType& Point) const;
+
+    int32 FindVertexTriangle(int32 VertexIndex) const;
+
+    // Reuses a removed triangle slot if any, otherwise appends one
+    int32 AllocateTriangle();
+
+    void SplitTriangle(int32 TriangleIndex, int32 VertexIndex);
+
+    void SplitEdge(int32 TriangleIndex, int32 EdgeIndex, int32 VertexIndex);
+
+    void Legalize();
+
+    void FlipEdge(int32 TriangleIndex, int32 EdgeIndex);
+
+    void ReplaceNeighbor(int32 TriangleIndex, int32 OldNeighbor, int32 NewNeighbor);
+
+    // Sets the neighbor across the edge joining vertices A and B of a triangle
+    void SetNeighborAcrossEdge(int32 TriangleIndex, int32 A, int32 B, int32 NewNeighbor);
+
+    // Last triangle touched by an insertion or a vertex lookup, used as the starting point of the next walk
+    mutable int32 LastTriangle = 0;
+
+    // Triangles whose edge opposite to the inserted vertex still has to be checked, reused between insertions
+    TArray<int32, AllocatorType> LegalizeStack;
+
+    // Slots of removed triangles
+    TArray<int32, AllocatorType> FreeTriangles;
+};
+
+// Mesh kept between edits, in world coordinates
+using SDelaunayMesh = TDelaunayMesh<>;
+
 UCLASS()
 class TP4_API UTriangulation : public UObject
 {
@@ -85,13 +204,35 @@ class TP4_API UTriangulation : public UObject
 
 public:
 
+    // Triangulates the points into an indexed mesh, mesh vertex i being Points[i]
+    // Precision selects the predicates, points closer than the fixed point resolution are merged with Fixed
+    static void GenerateMesh(TConstArrayView<FVector2D> Points, SDungeonMesh& OutMesh, EGeometryPrecision Precision = EGeometryPrecision::Double);
+
     static TArray<STriangle> GenerateTriangulation(const TArray<FVector2D>& Points);
 
+    // Reference Bowyer-Watson implementation, kept to compare results and timings against the incremental one
+    static TArray<STriangle> GenerateTriangulationBowyerWatson(const TArray<FVector2D>& Points);
+
+    // Orientation predicate, positive when A, B, C are counter-clockwise
+    static double Orient(const FVector2D& A, const FVector2D& B, const FVector2D& C);
+
+    // In-circle predicate, positive when D lies inside the circumcircle of the counter-clockwise triangle A, B, C
+    static double InCircle(const FVector2D& A, const FVector2D& B, const FVector2D& C, const FVector2D& D);
+
 private:
 
-    static STriangle GenerateSuperTriangle(const TArray<FVector2D>& Points);
+    template<typename PolicyType>
+    static void GenerateMesh(TConstArrayView<FVector2D> Points, SDungeonMesh& OutMesh);
+
+    // Fills OutOrder on the memory stack of the caller
+    static void GetInsertionOrder(TConstArrayView<FVector2D> Points, TDungeonScratchArray<int32>& OutOrder);
+
+    static STriangle GenerateSuperTriangle(TConstArrayView<FVector2D> Points);
+
+    // Whether the vertices of the triangle are within the coordinates SFixedGeometry can hold without clamping
+    static bool FitsFixedGrid(const STriangle& Triangle);
 
     static SCircumcircle GetCircumcircle(const STriangle& Triangle);
 
     static bool SharesVertexWithSuperTriangle(const STriangle& Triangle, const STriangle& SuperTriangle);
-};
\ No newline at end of file
+};
@@ -4,3 +4,5 @@
 #include "Modules/ModuleManager.h"
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, TP4, "TP4" );
+
+DEFINE_LOG_CATEGORY(LogDungeon);